@@ -7,6 +7,38 @@
 #pragma execution_character_set("utf-8")
 #endif
 #include <string>
+#include <string_view>
+#include <chrono>
+#include <ctime>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <filesystem>
+#include <mutex>
+#include <condition_variable>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "Synchronization.lib")
+#endif
+#endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#endif
+
+// Shared with LightLogWriteImplLib, the lock-free logger stays header-only
+#include "../LightLogWriteImplLib/include/LightLogTimestampCache.h"
+#include "../LightLogWriteImplLib/include/LightLogClock.h"
+#include "../LightLogWriteImplLib/include/LightLogFdFile.h"
 
 /**
  * @file LightLogWriteCommon.h
@@ -45,4 +77,240 @@ enum class LogQueueOverflowStrategy {
 	DropOldest  /*!< Drop the oldest log entry */
 };
 
+/**
+ * @brief Severity of a log statement, ordered from the most verbose to the most severe.
+ * @details Used by LIGHTLOG_WRITE together with LIGHTLOG_MIN_LEVEL (build time) and
+ * * LockFreeLogWriteImpl::SetLogLevel (runtime). Off as a threshold disables logging.
+ */
+enum class LogLevel : uint8_t {
+	Trace = 0,  /*!< Very detailed tracing           */
+	Debug = 1,  /*!< Debugging output                */
+	Info  = 2,  /*!< Normal operation                */
+	Warn  = 3,  /*!< Something unexpected happened   */
+	Error = 4,  /*!< An operation failed             */
+	Fatal = 5,  /*!< The process cannot go on        */
+	Off   = 6   /*!< As a threshold: disables logging */
+};
+
+/**
+ * @brief Build time threshold, define it to the numeric value of a LogLevel (e.g. -DLIGHTLOG_MIN_LEVEL=2).
+ * * Statements below it compile to nothing. Defaults to 0 (keep everything).
+ */
+#ifndef LIGHTLOG_MIN_LEVEL
+#define LIGHTLOG_MIN_LEVEL 0
+#endif
+
+constexpr int kLogMinCompiledLevel = LIGHTLOG_MIN_LEVEL;
+
+constexpr bool IsLogLevelCompiledIn(LogLevel eLevel)
+{
+	return static_cast<int>(eLevel) >= kLogMinCompiledLevel;
+}
+
+/**
+ * @brief Writes a message only if its constant level passes both thresholds.
+ * @details The runtime check is one relaxed atomic load and happens before tag and message are
+ * * evaluated, so a filtered statement never builds its strings.
+ */
+#define LIGHTLOG_WRITE(logger, level, tag, message)                               \
+	do {                                                                          \
+		if constexpr (IsLogLevelCompiledIn(level)) {                              \
+			if ((logger).IsLevelEnabled(level))                                   \
+				(logger).WriteLogContent(tag, message);                           \
+		}                                                                         \
+	} while (0)
+
+/**
+	* @brief Hints the CPU that the caller is busy waiting, used between polls of a spin loop
+	*/
+inline void LightLogCpuRelax()
+{
+#if LIGHTLOG_HAS_TSC
+	_mm_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+/**
+	* @brief A 32 bit word a thread can sleep on until another thread changes it
+	* @details futex on Linux, WaitOnAddress on Windows, a mutex and condition variable elsewhere.
+	* * Wait() returns once the word no longer holds the expected value, after a Wake, on timeout or
+	* * spuriously, so callers re-check their condition in a loop. Whoever changes the word wakes the
+	* * sleepers afterwards; that is the only system call, and callers skip it when the word says
+	* * nobody sleeps.
+	*/
+class LightLogParkingWord {
+public:
+	std::atomic<uint32_t>  value{ 0 };  /*!< The word sleepers compare against */
+
+	/**
+		* @brief Sleeps while value holds expected
+		* @param timeout Longest sleep, a negative timeout sleeps until woken
+		*/
+	void Wait(uint32_t expected, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1))
+	{
+#if defined(__linux__)
+		static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain 32 bit word");
+		struct timespec sTimeout;
+		struct timespec* pTimeout = nullptr;
+		if (timeout.count() >= 0) {
+			sTimeout.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+			sTimeout.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+			pTimeout = &sTimeout;
+		}
+		::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&value), FUTEX_WAIT_PRIVATE, expected, pTimeout, nullptr, 0);
+#elif defined(_WIN32)
+		DWORD waitMs = INFINITE;
+		if (timeout.count() >= 0)
+			waitMs = static_cast<DWORD>((std::min)((timeout.count() + 999999) / 1000000, static_cast<int64_t>(INFINITE - 1)));
+		::WaitOnAddress(&value, &expected, sizeof(uint32_t), waitMs);
+#else
+		std::unique_lock<std::mutex> sLock(sWaitMutex);
+		auto bChanged = [&] { return value.load(std::memory_order_acquire) != expected; };
+		if (timeout.count() < 0)
+			sWaitCondVar.wait(sLock, bChanged);
+		else
+			sWaitCondVar.wait_for(sLock, timeout, bChanged);
+#endif
+	}
+
+	void WakeOne()
+	{
+#if defined(__linux__)
+		::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&value), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+		::WakeByAddressSingle(&value);
+#else
+		// Taking the lock orders the change of value before a waiter's check
+		{ std::lock_guard<std::mutex> sLock(sWaitMutex); }
+		sWaitCondVar.notify_one();
+#endif
+	}
+
+	void WakeAll()
+	{
+#if defined(__linux__)
+		::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&value), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+		::WakeByAddressAll(&value);
+#else
+		{ std::lock_guard<std::mutex> sLock(sWaitMutex); }
+		sWaitCondVar.notify_all();
+#endif
+	}
+
+private:
+#if !defined(__linux__) && !defined(_WIN32)
+	std::mutex                 sWaitMutex;    /*!< Fallback: guards the check of value */
+	std::condition_variable    sWaitCondVar;  /*!< Fallback: where waiters sleep       */
+#endif
+};
+
+/**
+	* @brief Append-only log file written through a raw file descriptor
+	* @details Append() copies into an owned buffer and only calls write when the buffer is full, so a
+	* * batch of records costs one system call per buffer. A record larger than the buffer goes out
+	* * together with the pending bytes in a single writev. The file is opened in append mode.
+	* * The lib's LightLogFileSink without io_uring, mmap and compression; both write through LightLogFdFile.
+	* * Append, Flush and Close belong to the write thread; the counters can be read from any thread.
+	*/
+class LightLogBufferedFileSink {
+public:
+	static constexpr size_t kDefaultBufferSize = 1u << 20;  /*!< 1 MiB */
+	static constexpr size_t kMinBufferSize = 4096;          /*!< Smaller requests are rounded up */
+
+	LightLogBufferedFileSink() = default;
+	~LightLogBufferedFileSink()
+	{
+		Close();
+	}
+
+	LightLogBufferedFileSink(const LightLogBufferedFileSink&) = delete;
+	LightLogBufferedFileSink& operator=(const LightLogBufferedFileSink&) = delete;
+
+	/**
+		* @brief Flushes and closes the current file, then opens sPath for appending
+		* @param sPath The log file, its directory must exist
+		* @param bufferSize Size of the write buffer, the buffer is reallocated only when this changes
+		* @return false if the file could not be opened, the sink is closed then
+		*/
+	bool Open(const std::filesystem::path& sPath, size_t bufferSize = kDefaultBufferSize)
+	{
+		Close();
+
+		bufferSize = (std::max)(bufferSize, kMinBufferSize);
+		if (bufferSize != bufferCapacity) {
+			pWriteBuffer.reset(new char[bufferSize]);
+			bufferCapacity = bufferSize;
+		}
+		bufferUsed = 0;
+
+		fileHandle = LightLogFdFile::OpenAppend(sPath, sCounters);
+		return fileHandle >= 0;
+	}
+
+	bool IsOpen() const { return fileHandle >= 0; }
+
+	/**
+		* @brief Appends bytes to the write buffer, writing the buffer out when they do not fit
+		*/
+	void Append(const char* pData, size_t size)
+	{
+		if (fileHandle < 0 || size == 0)
+			return;
+		if (size <= bufferCapacity - bufferUsed) {
+			std::memcpy(pWriteBuffer.get() + bufferUsed, pData, size);
+			bufferUsed += size;
+			return;
+		}
+		if (size >= bufferCapacity) {
+			// Too big to buffer: pending bytes and the record leave in one call
+			LightLogFdFile::WriteOut(fileHandle, pWriteBuffer.get(), bufferUsed, pData, size, sCounters);
+			bufferUsed = 0;
+			return;
+		}
+		Flush();
+		std::memcpy(pWriteBuffer.get(), pData, size);
+		bufferUsed = size;
+	}
+
+	void Append(std::string_view sData) { Append(sData.data(), sData.size()); }
+
+	/**
+		* @brief Writes out the buffered bytes, call it at the end of every batch
+		*/
+	void Flush()
+	{
+		if (fileHandle < 0 || bufferUsed == 0)
+			return;
+		LightLogFdFile::WriteOut(fileHandle, pWriteBuffer.get(), bufferUsed, nullptr, 0, sCounters);
+		bufferUsed = 0;
+	}
+
+	/**
+		* @brief Flushes and closes the file, nothing happens if none is open
+		*/
+	void Close()
+	{
+		if (fileHandle < 0)
+			return;
+		Flush();
+		LightLogFdFile::Close(fileHandle);
+		fileHandle = -1;
+	}
+
+	/**
+		* @brief The counters, asyncWrites and syncCalls stay 0 here
+		*/
+	LightLogSinkStats GetStats() const { return sCounters.Load(); }
+
+private:
+	int                       fileHandle = -1;       /*!< File descriptor, -1 when closed  */
+	std::unique_ptr<char[]>   pWriteBuffer;          /*!< Pending bytes                    */
+	size_t                    bufferCapacity = 0;    /*!< Size of pWriteBuffer             */
+	size_t                    bufferUsed = 0;        /*!< Pending byte count               */
+	LightLogSinkCounters      sCounters;             /*!< See LightLogSinkStats            */
+};
+
 #endif // LIGHT_LOG_WRITE_COMMON_H
\ No newline at end of file
@@ -19,6 +19,12 @@
 #include <filesystem>
 #include <vector>
 #include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
 #include "LightLogWriteCommon.h"
 #include "convert_tools.h"
 
@@ -29,18 +35,73 @@
 
 /**
 	* @brief Structure for log message information.
-	* @param sLogTagNameVal The tag name of the log.
-	* * It can be used to categorize or identify the log message.
-	* * such as INFO , WARNING, ERROR, etc.
-	* @param sLogContentVal The content of the log message.
-	* * It contains the actual log message that will be written to the log file.
-	* * This can include any relevant information that needs to be logged, such as error messages, status updates, etc.
+	* @details A fixed size, trivially copyable record, so LockFreeQueue slots are filled and emptied with a
+	* * plain memcpy and steady state logging never calls the allocator. The tag name and the content are
+	* * stored contiguously in aInlineBytes; when they do not fit, one heap block is allocated (the spill path)
+	* * and whoever consumes the record must call ReleaseSpill().
+	* * Tag and content are UTF-8, the same bytes end up in the log file.
+	* @param tagBytes Size of the tag name in bytes.
+	* @param bodyBytes Size of the content in bytes.
+	* @param pSpillBytes Heap block holding tag and content when they do not fit inline, otherwise null.
+	* @param aInlineBytes Inline storage of tag and content.
 	*/
 struct LightLogWrite_Info {
-	std::wstring                   sLogTagNameVal;  /*!< Log tag name */
-	std::wstring                   sLogContentVal;  /*!< Log content */
+	// With the queue's sequence word in front a slot is exactly four cache lines
+	static constexpr size_t kRecordSize = 256 - sizeof(size_t);
+	static constexpr size_t kInlineCapacity = kRecordSize - sizeof(void*) - sizeof(uint64_t) - 2 * sizeof(uint32_t);
+
+	uint32_t                       tagBytes = 0;                  /*!< Tag name size in bytes            */
+	uint32_t                       bodyBytes = 0;                 /*!< Content size in bytes             */
+	char*                          pSpillBytes = nullptr;         /*!< Heap payload of oversized entries */
+	uint64_t                       enqueueTicks = 0;              /*!< LightLogClock ticks at the call   */
+	char                           aInlineBytes[kInlineCapacity]; /*!< Inline tag + content payload      */
+
+	LightLogWrite_Info() = default;
+
+	/**
+		* @brief Builds the record in place, used by LockFreeQueue::emplace so the content is copied once
+		*/
+	LightLogWrite_Info(std::string_view sTagName, std::string_view sContent, uint64_t captureTicks = LightLogClock::ReadTicks())
+	{
+		Assign(sTagName, sContent);
+		enqueueTicks = captureTicks;
+	}
+
+	void Assign(std::string_view sTagName, std::string_view sContent)
+	{
+		tagBytes = static_cast<uint32_t>(sTagName.size());
+		bodyBytes = static_cast<uint32_t>(sContent.size());
+		char* pPayload = aInlineBytes;
+		if (static_cast<size_t>(tagBytes) + bodyBytes > kInlineCapacity)
+			pPayload = pSpillBytes = new char[static_cast<size_t>(tagBytes) + bodyBytes];
+		std::memcpy(pPayload, sTagName.data(), tagBytes);
+		std::memcpy(pPayload + tagBytes, sContent.data(), bodyBytes);
+	}
+
+	void ReleaseSpill()
+	{
+		delete[] pSpillBytes;
+		pSpillBytes = nullptr;
+		tagBytes = 0;
+		bodyBytes = 0;
+	}
+
+	const char* PayloadBytes() const { return pSpillBytes ? pSpillBytes : aInlineBytes; }
+
+	std::string_view GetTagName() const
+	{
+		return { PayloadBytes(), tagBytes };
+	}
+
+	std::string_view GetContent() const
+	{
+		return { PayloadBytes() + tagBytes, bodyBytes };
+	}
 };
 
+static_assert(sizeof(LightLogWrite_Info) == LightLogWrite_Info::kRecordSize, "LightLogWrite_Info must stay one fixed size slot");
+static_assert(std::is_trivially_copyable_v<LightLogWrite_Info>, "LightLogWrite_Info must be trivially copyable");
+
 /**
 	* @brief Enum for strategies to handle full log queues.
 	* @details
@@ -114,16 +175,27 @@ struct LightLogWrite_Info {
 
 
 
+/**
+	* @brief Cache line size LockFreeQueue pads its slots and counters to
+	* @details A fixed 64 rather than std::hardware_destructive_interference_size, which GCC warns about
+	* * in headers because its value may change between compiler versions.
+	*/
+constexpr size_t kLockFreeCacheLineSize = 64;
+
 /**
 	* @brief A lock-free queue implementation using atomic operations
 	* * This queue is designed to be used in a multi-threaded environment where multiple threads can push and pop elements concurrently without locks.
 	* @param T The type of elements stored in the queue
-	* @details The queue uses a fixed-size array of nodes, each containing an atomic tail and head index to manage the queue state.
-	* * The queue supports push and pop operations, where push adds an element to the end of the queue and pop removes an element from the front.
-	* * The queue is designed to be lock-free, meaning that it does not use mutexes or other locking mechanisms to ensure thread safety.
+	* @param SlotAlign Alignment of every slot. The default starts each slot on its own cache line, so a producer
+	* * filling slot i and the consumer releasing slot i-1 never share a line; alignof(size_t) packs the slots.
+	* @details The queue uses a fixed-size array of slots, each holding one sequence word followed by the element.
+	* * The sequence equals the position a producer may claim the slot for, position + 1 once the element is
+	* * published, and position + capacity after the consumer took it out. The sequence word sits at the start
+	* * of the slot, so claiming a slot and writing the element start on the same cache line.
+	* * The slot array is allocated with SlotAlign alignment, the claim counters live on lines of their own.
 	* * The queue is implemented using a circular buffer, where the capacity is a power of two to optimize index calculations.
 	*/
-template <typename T>
+template <typename T, size_t SlotAlign = kLockFreeCacheLineSize>
 class LockFreeQueue {
 public:
 	explicit LockFreeQueue(size_t capacity)
@@ -133,12 +205,9 @@ public:
 			_capacityMask |= _capacityMask >> i;
 		_capacity = _capacityMask + 1;
 
-		_queue = (Node*)new char[sizeof(Node) * _capacity];
+		_queue = static_cast<Node*>(::operator new(sizeof(Node) * _capacity, std::align_val_t(alignof(Node))));
 		for (size_t i = 0; i < _capacity; ++i)
-		{
-			_queue[i].tail.store(i, std::memory_order_relaxed);
-			_queue[i].head.store(-1, std::memory_order_relaxed);
-		}
+			new (&_queue[i].sequence) std::atomic<size_t>(i);
 
 		_tail.store(0, std::memory_order_relaxed);
 		_head.store(0, std::memory_order_relaxed);
@@ -149,9 +218,12 @@ public:
 		for (size_t i = _head; i != _tail; ++i)
 			(&_queue[i & _capacityMask].data)->~T();
 
-		delete[](char*)_queue;
+		::operator delete(_queue, std::align_val_t(alignof(Node)));
 	}
 
+	LockFreeQueue(const LockFreeQueue&) = delete;
+	LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
 	size_t capacity() const { return _capacity; }
 
 	size_t size() const
@@ -161,19 +233,42 @@ public:
 	}
 
 	bool push(const T& data)
+	{
+		return emplace(data);
+	}
+
+	bool push(T&& data)
+	{
+		return emplace(std::move(data));
+	}
+
+	/**
+		* @brief Constructs an element directly in the claimed slot
+		* @return false if the queue is full, args are left untouched in that case
+		* @details The element is only constructed once a slot has been claimed, so a failed attempt costs nothing.
+		*/
+	template <typename... Args>
+	bool emplace(Args&&... args)
 	{
 		Node* node;
 		size_t tail = _tail.load(std::memory_order_relaxed);
 		for (;;)
 		{
 			node = &_queue[tail & _capacityMask];
-			if (node->tail.load(std::memory_order_relaxed) != tail)
-				return false;
-			if ((_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)))
+			// Acquire pairs with pop's release, the consumer is done with the old element
+			size_t sequence = node->sequence.load(std::memory_order_acquire);
+			if (sequence != tail)
+			{
+				if (static_cast<std::ptrdiff_t>(sequence - tail) < 0)
+					return false;
+				tail = _tail.load(std::memory_order_relaxed);
+				continue;
+			}
+			if (_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
 				break;
 		}
-		new (&node->data)T(data);
-		node->head.store(tail, std::memory_order_release);
+		new (&node->data)T(std::forward<Args>(args)...);
+		node->sequence.store(tail + 1, std::memory_order_release);
 		return true;
 	}
 
@@ -184,34 +279,239 @@ public:
 		for (;;)
 		{
 			node = &_queue[head & _capacityMask];
-			if (node->head.load(std::memory_order_relaxed) != head)
-				return false;
+			size_t sequence = node->sequence.load(std::memory_order_acquire);
+			if (sequence != head + 1)
+			{
+				if (static_cast<std::ptrdiff_t>(sequence - (head + 1)) < 0)
+					return false;
+				head = _head.load(std::memory_order_relaxed);
+				continue;
+			}
 			if (_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
 				break;
 		}
-		result = node->data;
+		result = std::move(node->data);
 		(&node->data)->~T();
-		node->tail.store(head + _capacity, std::memory_order_release);
+		node->sequence.store(head + _capacity, std::memory_order_release);
 		return true;
 	}
 
 private:
-	struct Node
+	struct alignas(SlotAlign) Node
+	{
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+private:
+	size_t                                                  _capacityMask;
+	Node*                                                   _queue;
+	size_t                                                  _capacity;
+	alignas(kLockFreeCacheLineSize) std::atomic<size_t>     _tail;
+	alignas(kLockFreeCacheLineSize) std::atomic<size_t>     _head;
+	char                                                    cacheLinePad[kLockFreeCacheLineSize - sizeof(std::atomic<size_t>)];
+};
+
+/**
+	* @brief Bounded multi-producer, single-consumer ring that overwrites the oldest element when full
+	* @param Dispose Functor called on an element that is overwritten before the consumer took it, or that
+	* * is still in the ring when it is destroyed, to free what the element owns
+	* @details Disruptor style: a producer claims a position with one fetch_add and always gets to publish,
+	* * it never waits for the consumer. Each slot has a state word holding the position of its element and
+	* * whether that element is being written, published or consumed. A producer that finds an older,
+	* * unconsumed element in its slot overwrites it. The consumer walks the positions in order and counts
+	* * every position whose element it never got, so records lost to overruns are counted exactly.
+	* * The consumer copies an element out and then claims it with a CAS on the state word; a failed CAS
+	* * means a producer overwrote it meanwhile and the copy is dropped, as with a seqlock. T must be
+	* * trivially copyable for that reason.
+	* * The one wait a producer may do is for a producer one lap behind that is still copying into the
+	* * same slot, which takes a full lap of claims during a single copy.
+	*/
+template <typename T, typename Dispose, size_t SlotAlign = kLockFreeCacheLineSize>
+class LockFreeOverwriteRing {
+	static_assert(std::is_trivially_copyable_v<T>, "LockFreeOverwriteRing copies elements out like a seqlock");
+
+public:
+	explicit LockFreeOverwriteRing(size_t capacity)
+	{
+		_capacityMask = capacity - 1;
+		for (size_t i = 1; i <= sizeof(void*) * 4; i <<= 1)
+			_capacityMask |= _capacityMask >> i;
+		_capacity = _capacityMask + 1;
+
+		_ring = static_cast<Node*>(::operator new(sizeof(Node) * _capacity, std::align_val_t(alignof(Node))));
+		// Position -1, consumed: empty for the first lap of producers
+		for (size_t i = 0; i < _capacity; ++i)
+			new (&_ring[i].state) std::atomic<uint64_t>(kConsumed);
+
+		_claim.store(0, std::memory_order_relaxed);
+		_read.store(0, std::memory_order_relaxed);
+	}
+
+	~LockFreeOverwriteRing()
+	{
+		for (size_t i = 0; i < _capacity; ++i)
+			if ((_ring[i].state.load(std::memory_order_relaxed) & kStateMask) == kPublished)
+				Dispose()(_ring[i].data);
+
+		::operator delete(_ring, std::align_val_t(alignof(Node)));
+	}
+
+	LockFreeOverwriteRing(const LockFreeOverwriteRing&) = delete;
+	LockFreeOverwriteRing& operator=(const LockFreeOverwriteRing&) = delete;
+
+	size_t capacity() const { return _capacity; }
+
+	/**
+		* @brief Positions claimed and not yet passed by the consumer, can exceed capacity under overrun
+		*/
+	size_t size() const
+	{
+		uint64_t readPos = _read.load(std::memory_order_acquire);
+		return static_cast<size_t>(_claim.load(std::memory_order_relaxed) - readPos);
+	}
+
+	/**
+		* @brief Constructs an element at the next position, overwriting the oldest one if the ring is full
+		*/
+	template <typename... Args>
+	void emplace(Args&&... args)
+	{
+		uint64_t position = _claim.fetch_add(1, std::memory_order_relaxed);
+		Node* node = &_ring[position & _capacityMask];
+		uint64_t state = node->state.load(std::memory_order_acquire);
+		for (;;)
+		{
+			// A later lap got the slot first, this element counts as overrun already
+			if (SlotEnd(state) > position)
+				return;
+			if ((state & kStateMask) == kWriting)
+			{
+				LightLogCpuRelax();
+				state = node->state.load(std::memory_order_acquire);
+				continue;
+			}
+			if (node->state.compare_exchange_weak(state, MakeState(position, kWriting), std::memory_order_acquire, std::memory_order_acquire))
+				break;
+		}
+		// The consumer never took the old element, its copy will fail the claim
+		if ((state & kStateMask) == kPublished)
+			Dispose()(node->data);
+		new (&node->data)T(std::forward<Args>(args)...);
+		node->state.store(MakeState(position, kPublished), std::memory_order_release);
+	}
+
+	/**
+		* @brief Takes the oldest element out, consumer only
+		* @param skipped Incremented by the number of positions passed over because they were overwritten
+		* @return false if the next element is not published yet
+		*/
+	bool pop(T& result, uint64_t& skipped)
+	{
+		uint64_t readPos = _read.load(std::memory_order_relaxed);
+		bool bPopped = false;
+		for (;;)
+		{
+			uint64_t claimed = _claim.load(std::memory_order_acquire);
+			if (claimed == readPos)
+				break;
+			// Everything a full lap behind the producers is gone, no need to visit it slot by slot
+			if (claimed - readPos > _capacity)
+			{
+				skipped += claimed - _capacity - readPos;
+				readPos = claimed - _capacity;
+			}
+			Node* node = &_ring[readPos & _capacityMask];
+			uint64_t state = node->state.load(std::memory_order_acquire);
+			uint64_t slotEnd = SlotEnd(state);
+			if (slotEnd > readPos + 1)
+			{
+				++skipped;
+				++readPos;
+				continue;
+			}
+			// Claimed but not yet published
+			if (slotEnd != readPos + 1 || (state & kStateMask) != kPublished)
+				break;
+			std::memcpy(static_cast<void*>(&result), static_cast<const void*>(&node->data), sizeof(T));
+			bool bClaimed = node->state.compare_exchange_strong(state, MakeState(readPos, kConsumed), std::memory_order_acq_rel, std::memory_order_relaxed);
+			++readPos;
+			if (bClaimed)
+			{
+				bPopped = true;
+				break;
+			}
+			++skipped;
+		}
+		_read.store(readPos, std::memory_order_release);
+		return bPopped;
+	}
+
+private:
+	static constexpr uint64_t kWriting = 1;    /*!< A producer is constructing the element */
+	static constexpr uint64_t kPublished = 2;  /*!< Ready for the consumer                 */
+	static constexpr uint64_t kConsumed = 3;   /*!< Taken by the consumer                  */
+	static constexpr uint64_t kStateMask = 3;
+
+	/**
+		* @brief Packs position + 1 above the two state bits, so the empty slot is position -1
+		*/
+	static uint64_t MakeState(uint64_t position, uint64_t slotState) { return ((position + 1) << 2) | slotState; }
+
+	/**
+		* @brief Position + 1 of the element a state word describes, 0 for an empty slot
+		*/
+	static uint64_t SlotEnd(uint64_t state) { return state >> 2; }
+
+	struct alignas(SlotAlign) Node
 	{
+		std::atomic<uint64_t> state;
 		T data;
-		std::atomic<size_t> tail;
-		std::atomic<size_t> head;
 	};
 
 private:
-	size_t                              _capacityMask;
-	Node* _queue;
-	size_t                               _capacity;
-	char                                 cacheLinePad1[64];
-	std::atomic<size_t>                  _tail;
-	char                                 cacheLinePad2[64];
-	std::atomic<size_t>                  _head;
-	char                                 cacheLinePad3[64];
+	size_t                                                  _capacityMask;
+	Node*                                                   _ring;
+	size_t                                                  _capacity;
+	alignas(kLockFreeCacheLineSize) std::atomic<uint64_t>   _claim;
+	alignas(kLockFreeCacheLineSize) std::atomic<uint64_t>   _read;
+	char                                                    cacheLinePad[kLockFreeCacheLineSize - sizeof(std::atomic<uint64_t>)];
+};
+
+/**
+	* @brief Frees the spilled payload of a LightLogWrite_Info the overwrite ring drops
+	*/
+struct LightLogWriteInfoDispose {
+	void operator()(LightLogWrite_Info& sInfo) const { sInfo.ReleaseSpill(); }
+};
+
+/**
+	* @brief What the write thread does when it finds the queue empty, see LockFreeLogWriteImpl::SetIdlePolicy
+	* @details It polls spinCount times with a CPU pause in between, then yieldCount times giving up its
+	* * time slice, and then parks until a producer wakes it. Spinning buys wakeup latency with CPU time;
+	* * with both counts zero the writer parks at once and costs nothing while the logger is idle.
+	*/
+struct LogWriterIdlePolicy {
+	uint32_t  spinCount = 256;  /*!< Polls with a pause instruction in between */
+	uint32_t  yieldCount = 16;  /*!< Polls with std::this_thread::yield        */
+};
+
+/**
+	* @brief Outcome of LockFreeLogWriteImpl::WriteLogContentFor
+	*/
+enum class LogWriteStatus {
+	Written,   /*!< The record is queued (DropOldest may have discarded an older one)  */
+	TimedOut,  /*!< Block mode: the queue stayed full for the whole timeout, not queued */
+	Stopped    /*!< The logger is shutting down, not queued                            */
+};
+
+/**
+	* @brief A log file switch queued by SetLogsFileName / SetLastingsLogs for the write thread
+	*/
+struct LogFileRequest {
+	bool          bLasting = false;  /*!< SetLastingsLogs: sPath is the directory of half-day files */
+	std::wstring  sPath;             /*!< File name, or the directory when bLasting              */
+	std::wstring  sBaseName;         /*!< Base name of half-day files                            */
 };
 
 /**
@@ -222,6 +522,8 @@ private:
 	*/
 class LockFreeLogWriteImpl {
 public:
+	static constexpr uint32_t kBlockedYieldCount = 16;  /*!< Block mode: retries with yield before a producer parks */
+
 	LockFreeLogWriteImpl(size_t maxQueueSize = 500000, LogQueueOverflowStrategy strategy = LogQueueOverflowStrategy::Block, size_t reportInterval = 100)
 		: kMaxQueueSize(maxQueueSize),
 		discardCount(0),
@@ -231,8 +533,11 @@ public:
 		queueFullStrategy(strategy),
 		reportInterval(reportInterval),
 		bHasLogLasting{ false },
-		pLogWriteQueue(maxQueueSize)
+		// Only the queue of the chosen strategy gets its full size
+		pLogWriteQueue(strategy == LogQueueOverflowStrategy::DropOldest ? 1 : maxQueueSize),
+		pOverwriteRing(strategy == LogQueueOverflowStrategy::DropOldest ? maxQueueSize : 1)
 	{
+		SetProducerWakeBatch(pLogWriteQueue.capacity() / 8);
 		sWrittenThreads = std::thread(&LockFreeLogWriteImpl::RunWriteThread, this);
 	}
 
@@ -240,11 +545,14 @@ public:
 		CloseLogStream();
 	}
 
+	/**
+		* @brief Switches to sFilename, the directory is created here and the write thread opens the file
+		* @details The write thread switches before it writes its next record, records still queued then
+		* * go to the new file, as they did when the file was reopened on the calling thread.
+		*/
 	void SetLogsFileName(const std::wstring& sFilename) {
-		std::lock_guard<std::mutex> sWriteLock(fileMutex);
-		if (pLogFileStream.is_open()) pLogFileStream.close();
 		ChecksDirectory(sFilename);
-		pLogFileStream.open(sFilename, std::ios::app);
+		RequestLogFile({ false, sFilename, std::wstring() });
 	}
 
 	void SetLogsFileName(const std::string& sFilename) {
@@ -255,11 +563,13 @@ public:
 		SetLogsFileName(U16StringToWString(sFilename));
 	}
 
+	/**
+		* @brief Writes to half-day files sBaseName + "YYYY_MM_DD_AM.log" / "_PM.log" in sFilePath
+		* @details Like SetLogsFileName the directory is created here and the write thread opens the file.
+		*/
 	void SetLastingsLogs(const std::wstring& sFilePath, const std::wstring& sBaseName) {
-		sLogLastingDir = sFilePath;
-		sLogsBasedName = sBaseName;
-		bHasLogLasting = true;
-		CreateLogsFile();
+		ChecksDirectory((std::filesystem::path(sFilePath) / sBaseName).wstring());
+		RequestLogFile({ true, sFilePath, sBaseName });
 	}
 
 	void SetLastingsLogs(const std::u16string& sFilePath, const std::u16string& sBaseName) {
@@ -269,50 +579,54 @@ public:
 		SetLastingsLogs(Utf8ConvertsToUcs4(sFilePath), Utf8ConvertsToUcs4(sBaseName));
 	}
 
-	void WriteLogContent(const std::wstring& sTypeVal, const std::wstring& sMessage) {
-		bool bNeedReport = false;
-		size_t currentDiscard = 0;
-		static thread_local bool inErrorReport = false;
+	/**
+		* @brief Writes a UTF-8 log message, the bytes are queued and written without any transcoding
+		*/
+	void WriteLogContent(std::string_view sTypeVal, std::string_view sMessage) {
+		WriteLogContentFor(sTypeVal, sMessage, std::chrono::nanoseconds(-1));
+	}
+
+	/**
+		* @brief Same as WriteLogContent, but in Block mode gives up once the queue has stayed full for timeout
+		* @param timeout Longest wait for space, negative waits as long as it takes, zero never waits
+		* @return Whether the record was queued
+		*/
+	LogWriteStatus WriteLogContentFor(std::string_view sTypeVal, std::string_view sMessage, std::chrono::nanoseconds timeout) {
+		// Taken before any retry so a blocked call is stamped with the time it was made
+		uint64_t captureTicks = LightLogClock::ReadTicks();
 
+		// The record is built straight in the claimed queue slot, the content is copied exactly once
 		if (queueFullStrategy == LogQueueOverflowStrategy::Block) {
 			// ֱɹд
-			while (!pLogWriteQueue.push({ sTypeVal, sMessage })) {
-				if (bIsStopLogging) return;
-				std::this_thread::yield();
+			if (!pLogWriteQueue.emplace(sTypeVal, sMessage, captureTicks)) {
+				LogWriteStatus eStatus = WaitForSpace(sTypeVal, sMessage, captureTicks, timeout);
+				if (eStatus != LogWriteStatus::Written) return eStatus;
 			}
 		}
 		else if (queueFullStrategy == LogQueueOverflowStrategy::DropOldest) {
-			if (!pLogWriteQueue.push({ sTypeVal, sMessage })) {
-				// ϵٲ
-				LightLogWrite_Info dummy;
-				pLogWriteQueue.pop(dummy);
-				pLogWriteQueue.push({ sTypeVal, sMessage });
-				++discardCount;
-				if (discardCount - lastReportedDiscardCount >= reportInterval) {
-					bNeedReport = true;
-					currentDiscard = discardCount;
-					lastReportedDiscardCount.store(discardCount.load());
-				}
-			}
-		}
-		pWrittenCondVar.notify_one();
-
-		if (bNeedReport && !inErrorReport) {
-			inErrorReport = true;
-			std::wstring overflowMsg = L"The log queue overflows and has been discarded "
-				+ std::to_wstring(currentDiscard) + L" logs";
-			//std::wcerr << L"[WriteLogContent] Report overflow: " << overflowMsg << std::endl;
-			WriteLogContent(L"LOG_OVERFLOW", overflowMsg);
-			inErrorReport = false;
+			// ʱϵļ¼д߳ͳƲϱ
+			pOverwriteRing.emplace(sTypeVal, sMessage, captureTicks);
 		}
+		WakeWriter();
+		return LogWriteStatus::Written;
+	}
+
+#ifdef __cpp_char8_t
+	void WriteLogContent(std::u8string_view sTypeVal, std::u8string_view sMessage) {
+		WriteLogContent(std::string_view(reinterpret_cast<const char*>(sTypeVal.data()), sTypeVal.size()),
+			std::string_view(reinterpret_cast<const char*>(sMessage.data()), sMessage.size()));
 	}
+#endif
 
-	void WriteLogContent(const std::string& sTypeVal, const std::string& sMessage) {
-		WriteLogContent(Utf8ConvertsToUcs4(sTypeVal), Utf8ConvertsToUcs4(sMessage));
+	/**
+		* @brief Writes a wide log message, it is converted to UTF-8 on the calling thread
+		*/
+	void WriteLogContent(const std::wstring& sTypeVal, const std::wstring& sMessage) {
+		WriteConvertedLogContent(sTypeVal, sMessage);
 	}
 
 	void WriteLogContent(const std::u16string& sTypeVal, const std::u16string& sMessage) {
-		WriteLogContent(U16StringToWString(sTypeVal), U16StringToWString(sMessage));
+		WriteConvertedLogContent(sTypeVal, sMessage);
 	}
 
 	size_t GetDiscardCount() const {
@@ -323,67 +637,343 @@ public:
 		discardCount = 0;
 	}
 
+	/**
+		* @brief Sets the size of the write thread's file buffer, 1 MiB by default
+		* @details Records are appended to this buffer and written with one system call when it is full or
+		* * the queue runs empty. Only applies to files opened afterwards.
+		*/
+	void SetWriteBufferSize(size_t bufferSize) {
+		writeBufferSize.store(bufferSize, std::memory_order_relaxed);
+	}
+
+	/**
+		* @brief Gets the system call and byte counters of the log file sink
+		*/
+	LightLogSinkStats GetSinkStats() const {
+		return pLogFileSink.GetStats();
+	}
+
+	/**
+		* @brief Sets the runtime threshold used by LIGHTLOG_WRITE, statements below it are skipped
+		*/
+	void SetLogLevel(LogLevel eLevel) {
+		eMinLogLevel.store(eLevel, std::memory_order_relaxed);
+	}
+
+	LogLevel GetLogLevel() const {
+		return eMinLogLevel.load(std::memory_order_relaxed);
+	}
+
+	/**
+		* @brief Checks a level against the runtime threshold, costs one relaxed atomic load
+		*/
+	bool IsLevelEnabled(LogLevel eLevel) const {
+		return eLevel >= eMinLogLevel.load(std::memory_order_relaxed);
+	}
+
+	/**
+		* @brief Sets how long the write thread polls an empty queue before it parks, see LogWriterIdlePolicy
+		*/
+	void SetIdlePolicy(const LogWriterIdlePolicy& sPolicy) {
+		idleSpinCount.store(sPolicy.spinCount, std::memory_order_relaxed);
+		idleYieldCount.store(sPolicy.yieldCount, std::memory_order_relaxed);
+	}
+
+	LogWriterIdlePolicy GetIdlePolicy() const {
+		LogWriterIdlePolicy sPolicy;
+		sPolicy.spinCount = idleSpinCount.load(std::memory_order_relaxed);
+		sPolicy.yieldCount = idleYieldCount.load(std::memory_order_relaxed);
+		return sPolicy;
+	}
+
+	/**
+		* @brief Block mode: how many slots the write thread frees before it wakes the parked producers
+		* @details Defaults to an eighth of the queue and is kept between 1 and half the queue. A larger
+		* * batch means fewer wake system calls and more records per producer wakeup. Whatever the batch,
+		* * producers are woken when the write thread runs the queue empty.
+		*/
+	void SetProducerWakeBatch(size_t slotCount) {
+		slotCount = (std::min)(slotCount, pLogWriteQueue.capacity() / 2);
+		producerWakeBatch.store((std::max)(slotCount, static_cast<size_t>(1)), std::memory_order_relaxed);
+	}
+
+	size_t GetProducerWakeBatch() const {
+		return producerWakeBatch.load(std::memory_order_relaxed);
+	}
+
 private:
+	/**
+		* @brief Converts tag and message to UTF-8 in per thread buffers, reused so converting does not allocate
+		*/
+	template <typename StringT>
+	void WriteConvertedLogContent(const StringT& sTypeVal, const StringT& sMessage) {
+		static thread_local std::string sUtf8TypeVal;
+		static thread_local std::string sUtf8Message;
+		sUtf8TypeVal.clear();
+		AppendUtf8(sUtf8TypeVal, sTypeVal);
+		sUtf8Message.clear();
+		AppendUtf8(sUtf8Message, sMessage);
+		WriteLogContent(std::string_view(sUtf8TypeVal), std::string_view(sUtf8Message));
+	}
+
 	std::wstring BuildLogFileOut() {
 		std::tm sTmPartsInfo = GetCurrsTimerTm();
 		std::wostringstream sWosStrStream;
-		sWosStrStream << std::put_time(&sTmPartsInfo, L"%Y_%m_%d") << (sTmPartsInfo.tm_hour >= 12 ? L"_AM" : L"_PM") << L".log";
-		bLastingTmTags = (sTmPartsInfo.tm_hour > 12);
+		sWosStrStream << std::put_time(&sTmPartsInfo, L"%Y_%m_%d") << (sTmPartsInfo.tm_hour < 12 ? L"_AM" : L"_PM") << L".log";
+		bLastingTmTags = (sTmPartsInfo.tm_hour >= 12);
 		std::filesystem::path sLotOutPaths = sLogLastingDir;
 		std::filesystem::path sLogOutFiles = sLotOutPaths / (sLogsBasedName + sWosStrStream.str());
 		return sLogOutFiles.wstring();
 	}
 
 	void CloseLogStream() {
+		// Queued before the flag is raised, so the writer cannot find the queue empty and leave without it
+		WriteLogContent("<================================              Stop log write thread    ", "================================>");
 		bIsStopLogging = true;
-		pWrittenCondVar.notify_all();
-		WriteLogContent(L"<================================              Stop log write thread    ", L"================================>");
+		WakeWriter();
+		// Blocked producers see the flag and give up
+		sProducerParking.value.fetch_add(1, std::memory_order_release);
+		sProducerParking.WakeAll();
 		if (sWrittenThreads.joinable()) sWrittenThreads.join();
 	}
 
+	// ֻд̵߳
 	void CreateLogsFile() {
 		std::wstring sOutFileName = BuildLogFileOut();
-		std::lock_guard<std::mutex> sLock(fileMutex);
 		ChecksDirectory(sOutFileName);
-		pLogFileStream.close();
-		pLogFileStream.open(sOutFileName, std::ios::app);
+		pLogFileSink.Open(std::filesystem::path(sOutFileName), writeBufferSize.load(std::memory_order_relaxed));
 	}
 
 	void RunWriteThread() {
 		while (true) {
-			// ǷҪл־ļAM/PMл
-			if (bHasLogLasting) {
-				bool isCurrentPM = (GetCurrsTimerTm().tm_hour > 12);
-				if (bLastingTmTags != isCurrentPM) {
-					CreateLogsFile();
-				}
-			}
-
 			LightLogWrite_Info sLogMessageInf;
-			bool hasLog = pLogWriteQueue.pop(sLogMessageInf);
+			bool hasLog = PopRecord(sLogMessageInf);
+			// ȡ¼֮ٿ¼֮ǰļлһɼ
+			if (bLogFileRequested.load(std::memory_order_acquire))
+				ApplyLogFileRequests();
 
 			// ֹֻͣ־ΪҶΪʱ˳
-			if (bIsStopLogging && pLogWriteQueue.size() == 0 && !hasLog) {
+			if (bIsStopLogging && QueuedRecordCount() == 0 && !hasLog) {
 				break;
 			}
 
-			// д־ݵļ
-			if (hasLog && !sLogMessageInf.sLogContentVal.empty() && pLogFileStream.is_open()) {
-				pLogFileStream << sLogMessageInf.sLogTagNameVal
-					<< L"-//>>>" << GetCurrentTimer()
-					<< L" : " << sLogMessageInf.sLogContentVal << L"\n";
+			if (hasLog) {
+				// ʹü¼ʱʱӼд߳ȡʱ
+				sTimestampCache.Update(sLogClock.ToTimePoint(sLogMessageInf.enqueueTicks));
+				// ǷҪл־ļAM/PMл
+				if (bHasLogLasting) {
+					bool isCurrentPM = (sTimestampCache.GetLocalHour() >= 12);
+					if (bLastingTmTags != isCurrentPM) {
+						CreateLogsFile();
+					}
+				}
+
+				// ϱ¼֮ǰǵļ¼
+				if (bNeedReport)
+					AppendOverflowReport();
+				// д־ݵļ
+				if (sLogMessageInf.bodyBytes != 0 && pLogFileSink.IsOpen()) {
+					sLineBuffer.assign(sLogMessageInf.GetTagName());
+					sLineBuffer += "-//>>>";
+					sLineBuffer += sTimestampCache.GetText();
+					sLineBuffer += " : ";
+					sLineBuffer += sLogMessageInf.GetContent();
+					sLineBuffer += '\n';
+					pLogFileSink.Append(sLineBuffer);
+				}
+				sLogMessageInf.ReleaseSpill();
+				if (++freedSinceWake >= producerWakeBatch.load(std::memory_order_relaxed))
+					ReleaseBlockedProducers();
 			}
-			else if (!hasLog) {
+			else {
+				if (freedSinceWake != 0)
+					ReleaseBlockedProducers();
+				// ѿգȰѻݽں
+				pLogFileSink.Flush();
 				// Ϊգæ
-				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				WaitForRecords();
 			}
 		}
 
 		// ر־ļ
-		pLogFileStream.close();
+		if (bNeedReport)
+			AppendOverflowReport();
+		pLogFileSink.Close();
 		std::cerr << "Log write thread Exit\n";
 	}
 
+	/**
+		* @brief Takes the next record from the queue of the configured strategy
+		* @details In DropOldest mode the positions the ring skipped are added to the discard count here,
+		* * and once reportInterval of them have piled up a LOG_OVERFLOW line is due before the next record.
+		*/
+	bool PopRecord(LightLogWrite_Info& sLogMessageInf) {
+		if (queueFullStrategy != LogQueueOverflowStrategy::DropOldest)
+			return pLogWriteQueue.pop(sLogMessageInf);
+		uint64_t skipped = 0;
+		bool bPopped = pOverwriteRing.pop(sLogMessageInf, skipped);
+		if (skipped != 0) {
+			size_t totalDiscard = discardCount.fetch_add(static_cast<size_t>(skipped), std::memory_order_relaxed) + static_cast<size_t>(skipped);
+			if (totalDiscard - lastReportedDiscardCount.load(std::memory_order_relaxed) >= reportInterval.load(std::memory_order_relaxed))
+				bNeedReport.store(true, std::memory_order_relaxed);
+		}
+		return bPopped;
+	}
+
+	size_t QueuedRecordCount() const {
+		if (queueFullStrategy == LogQueueOverflowStrategy::DropOldest)
+			return pOverwriteRing.size();
+		return pLogWriteQueue.size();
+	}
+
+	/**
+		* @brief Writes the LOG_OVERFLOW line straight to the file, write thread only
+		* @details Uses the timestamp of the record that follows the gap, or of the last record at exit.
+		*/
+	void AppendOverflowReport() {
+		bNeedReport.store(false, std::memory_order_relaxed);
+		size_t currentDiscard = discardCount.load(std::memory_order_relaxed);
+		lastReportedDiscardCount.store(currentDiscard, std::memory_order_relaxed);
+		if (!pLogFileSink.IsOpen())
+			return;
+		sLineBuffer.assign("LOG_OVERFLOW-//>>>");
+		sLineBuffer += sTimestampCache.GetText();
+		sLineBuffer += " : The log queue overflows and has been discarded ";
+		sLineBuffer += std::to_string(currentDiscard);
+		sLineBuffer += " logs\n";
+		pLogFileSink.Append(sLineBuffer);
+	}
+
+	/**
+		* @brief Block mode: waits for a free slot once emplace has failed, yielding first and then parking
+		* @details A producer registers in blockedProducers and then retries, with a full fence in between;
+		* * the write thread frees slots and then looks at blockedProducers in ReleaseBlockedProducers. The
+		* * retry failing means the queue was full after registering, so the writer has a batch or a drain
+		* * ahead of it and will bump the parking word.
+		*/
+	LogWriteStatus WaitForSpace(std::string_view sTypeVal, std::string_view sMessage, uint64_t captureTicks, std::chrono::nanoseconds timeout) {
+		auto sDeadline = std::chrono::steady_clock::time_point::max();
+		if (timeout.count() >= 0)
+			sDeadline = std::chrono::steady_clock::now() + timeout;
+		for (uint32_t attempt = 0;; ++attempt) {
+			if (bIsStopLogging) return LogWriteStatus::Stopped;
+			auto sNow = std::chrono::steady_clock::now();
+			if (sNow >= sDeadline) return LogWriteStatus::TimedOut;
+			if (attempt < kBlockedYieldCount) {
+				std::this_thread::yield();
+			}
+			else {
+				uint32_t generation = sProducerParking.value.load(std::memory_order_acquire);
+				blockedProducers.fetch_add(1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				bool bWritten = pLogWriteQueue.emplace(sTypeVal, sMessage, captureTicks);
+				if (!bWritten && !bIsStopLogging) {
+					auto waitTime = std::chrono::nanoseconds(-1);
+					if (sDeadline != std::chrono::steady_clock::time_point::max())
+						waitTime = std::chrono::duration_cast<std::chrono::nanoseconds>(sDeadline - sNow);
+					sProducerParking.Wait(generation, waitTime);
+				}
+				blockedProducers.fetch_sub(1, std::memory_order_relaxed);
+				if (bWritten) return LogWriteStatus::Written;
+			}
+			if (pLogWriteQueue.emplace(sTypeVal, sMessage, captureTicks))
+				return LogWriteStatus::Written;
+		}
+	}
+
+	/**
+		* @brief Write thread: wakes every parked producer after a batch of slots was freed or the queue ran empty
+		*/
+	void ReleaseBlockedProducers() {
+		freedSinceWake = 0;
+		if (queueFullStrategy != LogQueueOverflowStrategy::Block)
+			return;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (blockedProducers.load(std::memory_order_relaxed) == 0)
+			return;
+		sProducerParking.value.fetch_add(1, std::memory_order_release);
+		sProducerParking.WakeAll();
+	}
+
+	/**
+		* @brief Anything for the write thread to do: records, a log file request, or stopping
+		*/
+	bool HasRecordsOrStop() const {
+		return QueuedRecordCount() != 0 || bLogFileRequested.load(std::memory_order_relaxed)
+			|| bIsStopLogging.load(std::memory_order_relaxed);
+	}
+
+	/**
+		* @brief Queues a log file switch for the write thread, which owns the sink and never locks it
+		*/
+	void RequestLogFile(LogFileRequest sRequest) {
+		{
+			std::lock_guard<std::mutex> sLock(requestMutex);
+			vLogFileRequests.push_back(std::move(sRequest));
+			bLogFileRequested.store(true, std::memory_order_release);
+		}
+		WakeWriter();
+	}
+
+	/**
+		* @brief Write thread: applies the queued log file requests in order
+		* @details requestMutex is only taken here, after bLogFileRequested was seen set.
+		*/
+	void ApplyLogFileRequests() {
+		std::vector<LogFileRequest> vRequests;
+		{
+			std::lock_guard<std::mutex> sLock(requestMutex);
+			vRequests.swap(vLogFileRequests);
+			bLogFileRequested.store(false, std::memory_order_relaxed);
+		}
+		for (const LogFileRequest& sRequest : vRequests) {
+			if (sRequest.bLasting) {
+				sLogLastingDir = sRequest.sPath;
+				sLogsBasedName = sRequest.sBaseName;
+				bHasLogLasting = true;
+				CreateLogsFile();
+			}
+			else {
+				pLogFileSink.Open(std::filesystem::path(sRequest.sPath), writeBufferSize.load(std::memory_order_relaxed));
+			}
+		}
+	}
+
+	/**
+		* @brief Idles the write thread per the idle policy until the queue has records or logging stops
+		* @details Parking is a Dekker handshake with WakeWriter: the writer raises the flag and then looks
+		* * at the queue, a producer publishes its record and then looks at the flag, with a full fence on
+		* * both sides. At least one of them sees the other, so a record is never left behind a parked writer.
+		*/
+	void WaitForRecords() {
+		uint32_t spinCount = idleSpinCount.load(std::memory_order_relaxed);
+		for (uint32_t i = 0; i < spinCount; ++i) {
+			if (HasRecordsOrStop()) return;
+			LightLogCpuRelax();
+		}
+		uint32_t yieldCount = idleYieldCount.load(std::memory_order_relaxed);
+		for (uint32_t i = 0; i < yieldCount; ++i) {
+			if (HasRecordsOrStop()) return;
+			std::this_thread::yield();
+		}
+		sWriterParking.value.store(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!HasRecordsOrStop())
+			sWriterParking.Wait(1);
+		sWriterParking.value.store(0, std::memory_order_relaxed);
+	}
+
+	/**
+		* @brief Called by producers after publishing, costs a fence and a load unless the writer is parked
+		* @details Only the producer that clears the flag issues the wake system call.
+		*/
+	void WakeWriter() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (sWriterParking.value.load(std::memory_order_relaxed) != 0
+			&& sWriterParking.value.exchange(0, std::memory_order_relaxed) != 0)
+			sWriterParking.WakeOne();
+	}
+
 
 
 	void ChecksDirectory(const std::wstring& sFilename) {
@@ -395,13 +985,6 @@ private:
 		}
 	}
 
-	std::wstring GetCurrentTimer() const {
-		std::tm sTmPartsInfo = GetCurrsTimerTm();
-		std::wostringstream sWosStrStream;
-		sWosStrStream << std::put_time(&sTmPartsInfo, L"%Y-%m-%d %H:%M:%S");
-		return sWosStrStream.str();
-	}
-
 	std::tm GetCurrsTimerTm() const {
 		auto sCurrentTime = std::chrono::system_clock::now();
 		std::time_t sCurrTimerTm = std::chrono::system_clock::to_time_t(sCurrentTime);
@@ -418,10 +1001,17 @@ private:
 	//------------------------------------------------------------------------------------------------------------------------
 	// Section Name: Private Members @{
 	//------------------------------------------------------------------------------------------------------------------------
-	std::wofstream                        pLogFileStream;            /*!< Log file stream                                */
-	std::mutex                            fileMutex;                 /*!< Mutex for file operations                      */
-	LockFreeQueue<LightLogWrite_Info>     pLogWriteQueue;            /*!< Lock-free queue for log messages               */
-	std::condition_variable               pWrittenCondVar;           /*!< Condition variable for waking log write thread */
+	LightLogBufferedFileSink              pLogFileSink;              /*!< Buffered log file, raw UTF-8 bytes             */
+	std::mutex                            requestMutex;              /*!< Guards vLogFileRequests                        */
+	std::vector<LogFileRequest>           vLogFileRequests;          /*!< Log file switches for the write thread         */
+	std::atomic<bool>                     bLogFileRequested{ false }; /*!< vLogFileRequests is not empty                 */
+	LockFreeQueue<LightLogWrite_Info>     pLogWriteQueue;            /*!< Lock-free queue for log messages, Block mode   */
+	LockFreeOverwriteRing<LightLogWrite_Info, LightLogWriteInfoDispose> pOverwriteRing; /*!< Overwrite ring, DropOldest mode */
+	LightLogParkingWord                   sWriterParking;            /*!< 1 while the write thread is parked             */
+	LightLogParkingWord                   sProducerParking;          /*!< Bumped when blocked producers may retry        */
+	std::atomic<uint32_t>                 blockedProducers{ 0 };     /*!< Producers between registering and retrying     */
+	std::atomic<size_t>                   producerWakeBatch{ 1 };    /*!< See SetProducerWakeBatch                       */
+	size_t                                freedSinceWake = 0;        /*!< Write thread: slots freed since the last wake  */
 	std::thread                           sWrittenThreads;           /*!< Log write thread                               */
 	std::atomic<bool>                     bIsStopLogging;            /*!< Flag to stop logging                           */
 	std::wstring                          sLogLastingDir;            /*!< Directory for lasting logs                     */
@@ -433,7 +1023,14 @@ private:
 	std::atomic<size_t>                   discardCount;              /*!< Count of discarded logs                        */
 	std::atomic<size_t>                   lastReportedDiscardCount;  /*!< Last reported discard count                    */
 	std::atomic<size_t>                   reportInterval;            /*!< Interval for reporting discarded logs          */
-	std::atomic<bool>                     bNeedReport;               /*!< Flag to indicate if reporting is needed        */
+	std::atomic<bool>                     bNeedReport;               /*!< A LOG_OVERFLOW line is due, write thread       */
+	std::string                           sLineBuffer;               /*!< Write thread line buffer                       */
+	LightLogTimestampCache                sTimestampCache;           /*!< Write thread line timestamp                    */
+	LightLogClock                         sLogClock;                 /*!< Converts record ticks, write thread only       */
+	std::atomic<size_t>                   writeBufferSize{ LightLogBufferedFileSink::kDefaultBufferSize }; /*!< Sink buffer size for new files */
+	std::atomic<LogLevel>                 eMinLogLevel{ LogLevel::Trace }; /*!< Runtime level threshold                */
+	std::atomic<uint32_t>                 idleSpinCount{ LogWriterIdlePolicy().spinCount };   /*!< See LogWriterIdlePolicy */
+	std::atomic<uint32_t>                 idleYieldCount{ LogWriterIdlePolicy().yieldCount }; /*!< See LogWriterIdlePolicy */
 	//------------------------------------------------------------------------------------------------------------------------
 	// Section Name: Private Members @}
 	//------------------------------------------------------------------------------------------------------------------------
@@ -1,5 +1,8 @@
 #pragma once
 #include <string.h>
+#include <string>
+#include <string_view>
+#include <cstdint>
 #include <fstream>
 #include <codecvt>
 #include <locale>
@@ -8,3 +11,5 @@
 std::wstring    Utf8ConvertsToUcs4(const  std::string& utf8str);
 std::string     Ucs4ConvertToUtf8(const   std::wstring& wstr);
 std::wstring    U16StringToWString(const  std::u16string& u16str);
+void            AppendUtf8(std::string& sOut, std::wstring_view sInput);
+void            AppendUtf8(std::string& sOut, std::u16string_view sInput);
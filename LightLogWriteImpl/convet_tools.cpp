@@ -51,4 +51,50 @@ std::wstring U16StringToWString(const std::u16string& u16str)
 #endif
 
 	return wstr;
-}
\ No newline at end of file
+}
+
+
+
+// ַ׷Ϊ UTF-8 std::wstring_convertҲʱ
+// wchar_t  Windows  UTF-16ƽ̨ UCS-4
+template <size_t kUnitSize, typename StringViewT>
+static void AppendUtf8Units(std::string& sOut, StringViewT sInput)
+{
+	for (size_t i = 0; i < sInput.size(); ++i) {
+		uint32_t cp = static_cast<uint32_t>(sInput[i]);
+		if (cp < 0x80) {
+			sOut += static_cast<char>(cp);
+			continue;
+		}
+		if (kUnitSize == 2 && cp >= 0xD800 && cp <= 0xDBFF && i + 1 < sInput.size()) {
+			uint32_t low = static_cast<uint32_t>(sInput[i + 1]);
+			if (low >= 0xDC00 && low <= 0xDFFF) {
+				cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+				++i;
+			}
+		}
+		if (cp < 0x800) {
+			sOut += static_cast<char>(0xC0 | (cp >> 6));
+		}
+		else if (cp < 0x10000) {
+			sOut += static_cast<char>(0xE0 | (cp >> 12));
+			sOut += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+		}
+		else {
+			sOut += static_cast<char>(0xF0 | (cp >> 18));
+			sOut += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+			sOut += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+		}
+		sOut += static_cast<char>(0x80 | (cp & 0x3F));
+	}
+}
+
+void AppendUtf8(std::string& sOut, std::wstring_view sInput)
+{
+	AppendUtf8Units<sizeof(wchar_t)>(sOut, sInput);
+}
+
+void AppendUtf8(std::string& sOut, std::u16string_view sInput)
+{
+	AppendUtf8Units<2>(sOut, sInput);
+}
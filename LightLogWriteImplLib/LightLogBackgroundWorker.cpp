@@ -0,0 +1,88 @@
+#include "pch.h"
+#include "LightLogBackgroundWorker.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+LightLogBackgroundWorker::LightLogBackgroundWorker(size_t maxThreads, bool bLowPriority)
+	: maxThreads((std::max)(maxThreads, static_cast<size_t>(1))),
+	bLowPriority(bLowPriority)
+{
+}
+
+LightLogBackgroundWorker::~LightLogBackgroundWorker()
+{
+	{
+		std::lock_guard<std::mutex> sLock(pJobMutex);
+		bStopping = true;
+	}
+	pJobCondVar.notify_all();
+	for (auto& sWorkerThread : vWorkerThreads)
+		sWorkerThread.join();
+}
+
+void LightLogBackgroundWorker::Post(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> sLock(pJobMutex);
+		qJobs.push_back(std::move(job));
+		// Another thread only when every existing one is busy
+		if (vWorkerThreads.size() < maxThreads && runningJobs + qJobs.size() > vWorkerThreads.size())
+			vWorkerThreads.emplace_back(&LightLogBackgroundWorker::Run, this);
+	}
+	pJobCondVar.notify_all();
+}
+
+void LightLogBackgroundWorker::WaitIdle()
+{
+	std::unique_lock<std::mutex> sLock(pJobMutex);
+	pJobCondVar.wait(sLock, [this] { return qJobs.empty() && runningJobs == 0; });
+}
+
+void LightLogBackgroundWorker::Run()
+{
+	if (bLowPriority)
+		LowerThreadPriority();
+
+	std::unique_lock<std::mutex> sLock(pJobMutex);
+	while (true) {
+		pJobCondVar.wait(sLock, [this] { return !qJobs.empty() || bStopping; });
+		if (qJobs.empty())
+			break;
+		std::function<void()> job = std::move(qJobs.front());
+		qJobs.pop_front();
+		++runningJobs;
+		sLock.unlock();
+		try {
+			job();
+		}
+		catch (...) {
+		}
+		sLock.lock();
+		--runningJobs;
+		pJobCondVar.notify_all();
+	}
+}
+
+void LightLogBackgroundWorker::LowerThreadPriority()
+{
+#ifdef _WIN32
+	// Lowers CPU, I/O and memory priority of this thread
+	SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+#elif defined(__linux__)
+	// Per thread on Linux; without SCHED_IDLE (e.g. a seccomp profile) fall back to the lowest nice value
+	sched_param sParam{};
+	if (sched_setscheduler(0, SCHED_IDLE, &sParam) != 0)
+		setpriority(PRIO_PROCESS, 0, 19);
+#elif defined(__APPLE__)
+	pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+#endif
+}
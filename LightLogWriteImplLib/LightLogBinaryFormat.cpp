@@ -0,0 +1,166 @@
+#include "pch.h"
+#include "LightLogBinaryFormat.h"
+#include "LightLogFormat.h"
+#include "LightLogTagRegistry.h"
+
+namespace LightLogBinary {
+
+	void LightLogBinaryEncoder::BeginSegment(std::string& sOut, uint64_t baseTimeUs)
+	{
+		mTagIds.clear();
+		vRegisteredTagIds.clear();
+		mFormatIds.clear();
+		lastTimeUs = baseTimeUs;
+
+		sOut.append(kSegmentMagic, sizeof(kSegmentMagic));
+		sOut += static_cast<char>(kFormatVersion);
+		for (int i = 0; i < 8; ++i)
+			sOut += static_cast<char>((baseTimeUs >> (8 * i)) & 0xFF);
+	}
+
+	void LightLogBinaryEncoder::EncodeRecord(std::string& sOut, const LightLogWriteInfo& sLogMessageInf, std::string_view sTagName, uint64_t timeUs)
+	{
+		uint32_t tagId;
+		if (sLogMessageInf.tagId != kNoLogTagId) {
+			// Registered tags skip the name lookup, their segment id is cached by LogTagId
+			size_t index = static_cast<uint32_t>(sLogMessageInf.tagId);
+			if (index >= vRegisteredTagIds.size())
+				vRegisteredTagIds.resize(index + 1, 0);
+			if (vRegisteredTagIds[index] == 0)
+				vRegisteredTagIds[index] = GetTagId(sOut, sTagName) + 1;
+			tagId = vRegisteredTagIds[index] - 1;
+		}
+		else {
+			tagId = GetTagId(sOut, sTagName);
+		}
+		uint32_t formatId = kPlainMessageFormatId;
+
+		sArgsScratch.clear();
+		if (sLogMessageInf.pLogFormatVal) {
+			formatId = GetFormatId(sOut, sLogMessageInf.pLogFormatVal);
+			EncodeArgs(sArgsScratch, sLogMessageInf.GetArgs());
+		}
+		else {
+			// The message is already UTF-8, copy it as is
+			std::string_view sContent = sLogMessageInf.GetContent();
+			sArgsScratch += static_cast<char>(LogArgType::String);
+			PutVarint(sArgsScratch, sContent.size());
+			sArgsScratch += sContent;
+		}
+
+		if (sLogMessageInf.sequence != 0) {
+			sOut += static_cast<char>(kEntrySequence);
+			PutVarint(sOut, sLogMessageInf.sequence);
+		}
+		sOut += static_cast<char>(kEntryRecord);
+		PutSVarint(sOut, static_cast<int64_t>(timeUs - lastTimeUs));
+		PutVarint(sOut, tagId);
+		PutVarint(sOut, formatId);
+		PutVarint(sOut, sArgsScratch.size());
+		sOut += sArgsScratch;
+		lastTimeUs = timeUs;
+	}
+
+	uint32_t LightLogBinaryEncoder::GetTagId(std::string& sOut, std::string_view sTagName)
+	{
+		// Reuse the key buffer so looking up a known tag does not allocate
+		sTagKey.assign(sTagName);
+		auto it = mTagIds.find(sTagKey);
+		if (it != mTagIds.end())
+			return it->second;
+
+		uint32_t tagId = static_cast<uint32_t>(mTagIds.size());
+		mTagIds.emplace(sTagKey, tagId);
+
+		sOut += static_cast<char>(kEntryTagDef);
+		PutVarint(sOut, tagId);
+		PutVarint(sOut, sTagName.size());
+		sOut += sTagName;
+		return tagId;
+	}
+
+	uint32_t LightLogBinaryEncoder::GetFormatId(std::string& sOut, const wchar_t* pszFormat)
+	{
+		auto it = mFormatIds.find(pszFormat);
+		if (it != mFormatIds.end())
+			return it->second;
+
+		// Id 0 is the implicit plain message format
+		uint32_t formatId = static_cast<uint32_t>(mFormatIds.size()) + 1;
+		mFormatIds.emplace(pszFormat, formatId);
+
+		std::string sText;
+		AppendUtf8(sText, pszFormat);
+		sOut += static_cast<char>(kEntryFormatDef);
+		PutVarint(sOut, formatId);
+		PutVarint(sOut, sText.size());
+		sOut += sText;
+		return formatId;
+	}
+
+	void LightLogBinaryEncoder::EncodeArgs(std::string& sOut, std::string_view sArgsBuffer)
+	{
+		// Re-encode the in-memory layout of EncodeLogArgs: integers become varints, text becomes UTF-8
+		const char* pIn = sArgsBuffer.data();
+		const char* pEnd = pIn + sArgsBuffer.size();
+		auto read = [&](auto& value) {
+			std::memcpy(&value, pIn, sizeof(value));
+			pIn += sizeof(value);
+		};
+
+		while (pIn < pEnd) {
+			LogArgType type = static_cast<LogArgType>(*pIn++);
+			switch (type) {
+			case LogArgType::Int64: {
+				int64_t value; read(value);
+				sOut += static_cast<char>(type);
+				PutSVarint(sOut, value);
+				break;
+			}
+			case LogArgType::UInt64:
+			case LogArgType::Pointer: {
+				uint64_t value;
+				if (type == LogArgType::Pointer) { uintptr_t address; read(address); value = address; }
+				else read(value);
+				sOut += static_cast<char>(type);
+				PutVarint(sOut, value);
+				break;
+			}
+			case LogArgType::Double:
+				sOut += static_cast<char>(type);
+				sOut.append(pIn, sizeof(double));
+				pIn += sizeof(double);
+				break;
+			case LogArgType::Bool:
+			case LogArgType::Char:
+				sOut += static_cast<char>(type);
+				sOut += *pIn++;
+				break;
+			case LogArgType::WChar: {
+				uint32_t value; read(value);
+				sOut += static_cast<char>(type);
+				PutVarint(sOut, value);
+				break;
+			}
+			case LogArgType::WString: {
+				uint32_t len; read(len);
+				sTextScratch.clear();
+				AppendUtf8FromWideBytes(sTextScratch, pIn, len);
+				pIn += len * sizeof(wchar_t);
+				sOut += static_cast<char>(LogArgType::String);
+				PutVarint(sOut, sTextScratch.size());
+				sOut += sTextScratch;
+				break;
+			}
+			case LogArgType::String: {
+				uint32_t len; read(len);
+				sOut += static_cast<char>(type);
+				PutVarint(sOut, len);
+				sOut.append(pIn, len);
+				pIn += len;
+				break;
+			}
+			}
+		}
+	}
+}
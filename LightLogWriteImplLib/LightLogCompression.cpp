@@ -0,0 +1,125 @@
+#include "pch.h"
+#include "LightLogCompression.h"
+
+#include <fstream>
+#include <memory>
+#include <system_error>
+
+#ifdef LIGHTLOG_HAVE_ZLIB
+#include <zlib.h>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#endif
+
+namespace LightLogCompression {
+
+	bool IsAvailable(LogCompression eCompression)
+	{
+		if (eCompression == LogCompression::None)
+			return true;
+#ifdef LIGHTLOG_HAVE_ZLIB
+		return eCompression == LogCompression::Gzip;
+#else
+		return false;
+#endif
+	}
+
+	std::filesystem::path CompressedPath(const std::filesystem::path& sPath, LogCompression eCompression)
+	{
+		std::filesystem::path sCompressedPath = sPath;
+		if (eCompression == LogCompression::Gzip)
+			sCompressedPath += ".gz";
+		return sCompressedPath;
+	}
+
+#ifdef LIGHTLOG_HAVE_ZLIB
+
+	bool CompressFile(const std::filesystem::path& sPath, LogCompression eCompression)
+	{
+		static constexpr size_t kChunkSize = 256u << 10;
+
+		if (eCompression != LogCompression::Gzip)
+			return false;
+		std::ifstream sInput(sPath, std::ios::binary);
+		if (!sInput)
+			return false;
+
+		std::error_code sError;
+		std::filesystem::path sTarget = CompressedPath(sPath, eCompression);
+		std::filesystem::path sTemp = sTarget;
+		sTemp += ".tmp";
+		// An earlier file of the same name keeps its data, the new one follows as a second gzip member
+		bool bAppend = std::filesystem::exists(sTarget, sError);
+		if (bAppend && !std::filesystem::copy_file(sTarget, sTemp, std::filesystem::copy_options::overwrite_existing, sError))
+			return false;
+
+#ifdef _WIN32
+		int fileHandle = _wopen(sTemp.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY | (bAppend ? _O_APPEND : _O_TRUNC), _S_IREAD | _S_IWRITE);
+		int syncHandle = fileHandle >= 0 ? _dup(fileHandle) : -1;
+#else
+		int fileHandle = ::open(sTemp.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (bAppend ? O_APPEND : O_TRUNC), 0644);
+		int syncHandle = fileHandle >= 0 ? ::dup(fileHandle) : -1;
+#endif
+		// gzclose closes fileHandle, the duplicate is kept for the sync after it
+		gzFile pGzFile = syncHandle >= 0 ? gzdopen(fileHandle, bAppend ? "ab6" : "wb6") : nullptr;
+		bool bOk = pGzFile != nullptr;
+		if (!bOk && fileHandle >= 0) {
+#ifdef _WIN32
+			_close(fileHandle);
+#else
+			::close(fileHandle);
+#endif
+		}
+
+		std::unique_ptr<char[]> pChunk(new char[kChunkSize]);
+		while (bOk && sInput) {
+			sInput.read(pChunk.get(), kChunkSize);
+			auto chunkSize = static_cast<int>(sInput.gcount());
+			if (chunkSize > 0 && gzwrite(pGzFile, pChunk.get(), static_cast<unsigned>(chunkSize)) != chunkSize)
+				bOk = false;
+		}
+		bOk = bOk && !sInput.bad();
+		if (pGzFile && gzclose(pGzFile) != Z_OK)
+			bOk = false;
+		if (syncHandle >= 0) {
+#ifdef _WIN32
+			bOk = bOk && _commit(syncHandle) == 0;
+			_close(syncHandle);
+#elif defined(__APPLE__)
+			bOk = bOk && ::fsync(syncHandle) == 0;
+			::close(syncHandle);
+#else
+			bOk = bOk && ::fdatasync(syncHandle) == 0;
+			::close(syncHandle);
+#endif
+		}
+		sInput.close();
+
+		if (!bOk) {
+			std::filesystem::remove(sTemp, sError);
+			return false;
+		}
+		std::filesystem::rename(sTemp, sTarget, sError);
+		if (sError) {
+			std::filesystem::remove(sTemp, sError);
+			return false;
+		}
+		std::filesystem::remove(sPath, sError);
+		return true;
+	}
+
+#else
+
+	bool CompressFile(const std::filesystem::path&, LogCompression)
+	{
+		return false;
+	}
+
+#endif
+}
@@ -0,0 +1,239 @@
+#include "pch.h"
+#include "LightLogFileSink.h"
+#include "LightLogIoUring.h"
+#include "LightLogMmapSink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+LightLogFileSink::LightLogFileSink()
+	: sCounters(sOwnCounters)
+{
+}
+
+LightLogFileSink::LightLogFileSink(LightLogSinkCounters& sSharedCounters)
+	: sCounters(sSharedCounters)
+{
+}
+
+LightLogFileSink::~LightLogFileSink()
+{
+	Close();
+}
+
+bool LightLogFileSink::Open(const std::filesystem::path& sPath, size_t bufferSize, LogFileSinkMode eMode, size_t segmentSize,
+	LogCompression eCompression, size_t frameSize)
+{
+	Close();
+
+	bufferSize = (std::max)(bufferSize, kMinBufferSize);
+	bufferUsed = 0;
+	if (!LightLogCompression::IsAvailable(eCompression))
+		eCompression = LogCompression::None;
+
+	// Frames are written by the encoder, there is nothing for a mapping to save then
+	if (eMode == LogFileSinkMode::Mmap && eCompression == LogCompression::None) {
+		// Records are copied into the mapping directly, no write buffer in between
+		pMmapSink = LightLogMmapSink::Create(sPath, segmentSize, sCounters);
+		if (pMmapSink)
+			return true;
+	}
+
+	fileHandle = LightLogFdFile::OpenAppend(sPath, sCounters);
+	if (fileHandle < 0)
+		return false;
+
+	if (eCompression != LogCompression::None) {
+		// Frame offsets are absolute, an existing file is continued at its end
+#ifdef _WIN32
+		int64_t fileOffset = _lseeki64(fileHandle, 0, SEEK_END);
+#else
+		off_t fileOffset = ::lseek(fileHandle, 0, SEEK_END);
+#endif
+		if (fileOffset >= 0)
+			pFrameEncoder = LightLogFrameEncoder::Create(frameSize, static_cast<uint64_t>(fileOffset));
+	}
+
+	if (eMode == LogFileSinkMode::IoUring)
+		pIoUring = LightLogIoUring::Create(fileHandle, bufferSize, sCounters);
+	if (pIoUring) {
+		pWriteBuffer.reset();
+		pActiveBuffer = pIoUring->AcquireBuffer();
+	}
+	else {
+		if (!pWriteBuffer || bufferSize != bufferCapacity)
+			pWriteBuffer.reset(new char[bufferSize]);
+		pActiveBuffer = pWriteBuffer.get();
+	}
+	bufferCapacity = bufferSize;
+	return true;
+}
+
+void LightLogFileSink::Append(const char* pData, size_t size, uint64_t timeUs)
+{
+	if (pFrameEncoder) {
+		if (size == 0)
+			return;
+		pFrameEncoder->AppendRecord(pData, size, timeUs, sFrameBytes);
+		if (!sFrameBytes.empty()) {
+			AppendBytes(sFrameBytes.data(), sFrameBytes.size());
+			sFrameBytes.clear();
+		}
+		return;
+	}
+	AppendBytes(pData, size);
+}
+
+void LightLogFileSink::AppendBytes(const char* pData, size_t size)
+{
+	if (pMmapSink) {
+		pMmapSink->Append(pData, size);
+		return;
+	}
+	if (fileHandle < 0 || size == 0)
+		return;
+	bUnsynced = true;
+	if (size <= bufferCapacity - bufferUsed) {
+		std::memcpy(pActiveBuffer + bufferUsed, pData, size);
+		bufferUsed += size;
+		return;
+	}
+	if (size >= bufferCapacity) {
+		// Too big to buffer: pending bytes and the record leave in one call
+		if (pIoUring) {
+			SubmitBuffer();
+			pIoUring->WriteNow(pData, size);
+			return;
+		}
+		LightLogFdFile::WriteOut(fileHandle, pActiveBuffer, bufferUsed, pData, size, sCounters);
+		bufferUsed = 0;
+		return;
+	}
+	SubmitBuffer();
+	std::memcpy(pActiveBuffer, pData, size);
+	bufferUsed = size;
+}
+
+void LightLogFileSink::Flush()
+{
+	// Nothing to do in Mmap mode, writeback of the mapping is left to the kernel
+	if (fileHandle < 0)
+		return;
+	if (pFrameEncoder && std::chrono::steady_clock::now() >= pFrameEncoder->GetFrameDeadline())
+		EndFrame();
+	SubmitBuffer();
+}
+
+std::chrono::steady_clock::time_point LightLogFileSink::GetFrameDeadline() const
+{
+	if (!pFrameEncoder)
+		return std::chrono::steady_clock::time_point::max();
+	return pFrameEncoder->GetFrameDeadline();
+}
+
+void LightLogFileSink::EndFrame()
+{
+	pFrameEncoder->EndFrame(sFrameBytes);
+	if (!sFrameBytes.empty()) {
+		AppendBytes(sFrameBytes.data(), sFrameBytes.size());
+		sFrameBytes.clear();
+	}
+}
+
+void LightLogFileSink::Sync()
+{
+	if (pMmapSink) {
+		pMmapSink->Sync();
+		return;
+	}
+	if (pFrameEncoder)
+		EndFrame();
+	if (fileHandle < 0 || !bUnsynced)
+		return;
+	SubmitBuffer();
+	if (pIoUring)
+		pIoUring->WaitAll();
+#ifdef _WIN32
+	int result = _commit(fileHandle);
+#elif defined(__APPLE__)
+	int result = ::fsync(fileHandle);
+#else
+	int result = ::fdatasync(fileHandle);
+#endif
+	LightLogSinkCounters::Add(sCounters.syncCalls, 1);
+	if (result != 0)
+		LightLogSinkCounters::Add(sCounters.failedWrites, 1);
+	bUnsynced = false;
+}
+
+bool LightLogFileSink::StartsNewSegment(size_t size) const
+{
+	if (pFrameEncoder)
+		return pFrameEncoder->StartsNewFrame(size);
+	return pMmapSink && pMmapSink->StartsNewSegment(size);
+}
+
+void LightLogFileSink::SubmitBuffer()
+{
+	if (bufferUsed == 0)
+		return;
+	if (pIoUring) {
+		pIoUring->Submit(pActiveBuffer, bufferUsed);
+		pActiveBuffer = pIoUring->AcquireBuffer();
+	}
+	else {
+		LightLogFdFile::WriteOut(fileHandle, pActiveBuffer, bufferUsed, nullptr, 0, sCounters);
+	}
+	bufferUsed = 0;
+}
+
+void LightLogFileSink::Close()
+{
+	pMmapSink.reset();
+	if (fileHandle < 0)
+		return;
+	if (pFrameEncoder) {
+		pFrameEncoder->Finish(sFrameBytes);
+		AppendBytes(sFrameBytes.data(), sFrameBytes.size());
+		sFrameBytes.clear();
+		pFrameEncoder.reset();
+	}
+	SubmitBuffer();
+	pIoUring.reset();
+	pActiveBuffer = nullptr;
+	bUnsynced = false;
+	LightLogFdFile::Close(fileHandle);
+	fileHandle = -1;
+}
+
+void LightLogFileSink::Adopt(LightLogFileSink& sPrepared)
+{
+	Close();
+	// The io_uring and mmap sink count into sCounters by reference, hence the shared counters
+	std::swap(fileHandle, sPrepared.fileHandle);
+	std::swap(pWriteBuffer, sPrepared.pWriteBuffer);
+	std::swap(pActiveBuffer, sPrepared.pActiveBuffer);
+	std::swap(bufferCapacity, sPrepared.bufferCapacity);
+	std::swap(bufferUsed, sPrepared.bufferUsed);
+	std::swap(bUnsynced, sPrepared.bUnsynced);
+	std::swap(pIoUring, sPrepared.pIoUring);
+	std::swap(pMmapSink, sPrepared.pMmapSink);
+	std::swap(pFrameEncoder, sPrepared.pFrameEncoder);
+}
+
+LightLogSinkStats LightLogFileSink::GetStats() const
+{
+	return sCounters.Load();
+}
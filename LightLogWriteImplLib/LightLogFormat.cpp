@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "LightLogFormat.h"
+#include "LightLogUtf8.h"
+
+#include <charconv>
+
+namespace {
+
+	template <typename T>
+	T ReadValue(const char*& pIn)
+	{
+		T value;
+		std::memcpy(&value, pIn, sizeof(T));
+		pIn += sizeof(T);
+		return value;
+	}
+
+	template <typename T>
+	void AppendNumber(std::string& sOutput, T value, int base = 10)
+	{
+		char sDigits[32];
+		std::to_chars_result result;
+		if constexpr (std::is_integral_v<T>)
+			result = std::to_chars(sDigits, sDigits + sizeof(sDigits), value, base);
+		else
+			result = std::to_chars(sDigits, sDigits + sizeof(sDigits), value);
+		sOutput.append(sDigits, result.ptr);
+	}
+
+	/**
+		* @brief Renders the argument at pIn and advances pIn past it
+		*/
+	void AppendArg(std::string& sOutput, const char*& pIn)
+	{
+		LogArgType type = static_cast<LogArgType>(*pIn++);
+		switch (type) {
+		case LogArgType::Int64:
+			AppendNumber(sOutput, ReadValue<int64_t>(pIn));
+			break;
+		case LogArgType::UInt64:
+			AppendNumber(sOutput, ReadValue<uint64_t>(pIn));
+			break;
+		case LogArgType::Double:
+			AppendNumber(sOutput, ReadValue<double>(pIn));
+			break;
+		case LogArgType::Bool:
+			sOutput += (*pIn++ ? "true" : "false");
+			break;
+		case LogArgType::WChar: {
+			wchar_t ch = static_cast<wchar_t>(ReadValue<uint32_t>(pIn));
+			AppendUtf8(sOutput, std::wstring_view(&ch, 1));
+			break;
+		}
+		case LogArgType::Char:
+			sOutput += *pIn++;
+			break;
+		case LogArgType::Pointer:
+			sOutput += "0x";
+			AppendNumber(sOutput, ReadValue<uintptr_t>(pIn), 16);
+			break;
+		case LogArgType::WString: {
+			uint32_t len = ReadValue<uint32_t>(pIn);
+			AppendUtf8FromWideBytes(sOutput, pIn, len);
+			pIn += len * sizeof(wchar_t);
+			break;
+		}
+		case LogArgType::String: {
+			uint32_t len = ReadValue<uint32_t>(pIn);
+			sOutput.append(pIn, len);
+			pIn += len;
+			break;
+		}
+		}
+	}
+}
+
+void RenderLogFormat(std::string& sOutput, const wchar_t* pszFormat, std::string_view sArgsBuffer)
+{
+	const char* pIn = sArgsBuffer.data();
+	const char* pEnd = pIn + sArgsBuffer.size();
+
+	// Literal text is converted a run at a time, between placeholders and escapes
+	const wchar_t* pRun = pszFormat;
+	const wchar_t* p = pszFormat;
+	for (; *p != L'\0'; ++p) {
+		bool bEscaped = (p[0] == L'{' && p[1] == L'{') || (p[0] == L'}' && p[1] == L'}');
+		if (!bEscaped && !(p[0] == L'{' && p[1] == L'}'))
+			continue;
+		AppendUtf8(sOutput, std::wstring_view(pRun, (p - pRun) + (bEscaped ? 1 : 0)));
+		if (!bEscaped && pIn < pEnd)
+			AppendArg(sOutput, pIn);
+		++p;
+		pRun = p + 1;
+	}
+	AppendUtf8(sOutput, std::wstring_view(pRun, p - pRun));
+}
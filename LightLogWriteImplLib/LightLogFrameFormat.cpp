@@ -0,0 +1,360 @@
+#include "pch.h"
+#include "LightLogFrameFormat.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+#ifdef LIGHTLOG_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace LightLogFrameFormat;
+
+namespace {
+
+	constexpr int kCompressionLevel = 1;  /*!< Fastest zlib level, the write thread compresses */
+
+	void PutLe(std::string& sOut, uint64_t value, int bytes)
+	{
+		for (int i = 0; i < bytes; ++i)
+			sOut.push_back(static_cast<char>(value >> (8 * i)));
+	}
+
+	uint64_t GetLe(const char* pIn, int bytes)
+	{
+		uint64_t value = 0;
+		for (int i = 0; i < bytes; ++i)
+			value |= static_cast<uint64_t>(static_cast<unsigned char>(pIn[i])) << (8 * i);
+		return value;
+	}
+
+	void PutMemberHeader(std::string& sOut, char id, size_t payloadSize)
+	{
+		static const unsigned char kGzipHeader[10] = { 0x1f, 0x8b, 0x08, 0x04, 0, 0, 0, 0, 0, 0xff };
+		sOut.append(reinterpret_cast<const char*>(kGzipHeader), sizeof(kGzipHeader));
+		PutLe(sOut, 4 + payloadSize, 2);
+		sOut.push_back('L');
+		sOut.push_back(id);
+		PutLe(sOut, payloadSize, 2);
+	}
+
+	/**
+		* @brief An empty raw deflate stream (one final fixed block holding only its end code), CRC32 and ISIZE of nothing
+		*/
+	void PutEmptyBody(std::string& sOut)
+	{
+		sOut.push_back(0x03);
+		sOut.push_back(0x00);
+		PutLe(sOut, 0, 8);
+	}
+
+	/**
+		* @brief Checks kHeaderSize bytes for one of our member headers
+		*/
+	bool ParseMemberHeader(const char* pIn, char& id, size_t& payloadSize)
+	{
+		static const unsigned char kGzipHeader[10] = { 0x1f, 0x8b, 0x08, 0x04, 0, 0, 0, 0, 0, 0xff };
+		if (std::memcmp(pIn, kGzipHeader, sizeof(kGzipHeader)) != 0 || pIn[12] != 'L')
+			return false;
+		id = pIn[13];
+		payloadSize = static_cast<size_t>(GetLe(pIn + 14, 2));
+		return GetLe(pIn + 10, 2) == payloadSize + 4;
+	}
+
+	bool ReadAt(std::ifstream& sFile, uint64_t offset, size_t size, std::string& sOut)
+	{
+		sOut.resize(size);
+		sFile.clear();
+		sFile.seekg(static_cast<std::streamoff>(offset));
+		sFile.read(&sOut[0], static_cast<std::streamsize>(size));
+		return static_cast<size_t>(sFile.gcount()) == size;
+	}
+
+	/**
+		* @brief Walks the members in [0, end), the recovery path for sessions without a trailer
+		* @return false if the first member is not one of ours
+		*/
+	bool ScanFrames(std::ifstream& sFile, uint64_t end, std::vector<FrameEntry>& vFrames)
+	{
+		std::string sHeader;
+		uint64_t offset = 0;
+		while (offset + kHeaderSize + kFrameExtraSize <= end && ReadAt(sFile, offset, kHeaderSize + kFrameExtraSize, sHeader)) {
+			char id;
+			size_t payloadSize;
+			if (!ParseMemberHeader(sHeader.data(), id, payloadSize))
+				break;
+			uint64_t memberSize = kHeaderSize + payloadSize + 10;
+			if (id == kFrameId) {
+				if (payloadSize != kFrameExtraSize)
+					break;
+				memberSize = GetLe(sHeader.data() + kHeaderSize, 4);
+			}
+			else if (id != kIndexId && id != kTrailerId) {
+				break;
+			}
+			// A frame cut short by the crash ends the list
+			if (memberSize < kHeaderSize + payloadSize + 10 || memberSize > end - offset)
+				break;
+			if (id == kFrameId)
+				vFrames.push_back({ offset, GetLe(sHeader.data() + kHeaderSize + 4, 8) });
+			offset += memberSize;
+		}
+		return offset != 0 || end == 0;
+	}
+
+	/**
+		* @brief Reads the index members of a session, [indexOffset, indexEnd)
+		*/
+	bool ReadIndexMembers(std::ifstream& sFile, uint64_t indexOffset, uint64_t indexEnd, std::vector<FrameEntry>& vFrames)
+	{
+		std::string sIndex;
+		if (!ReadAt(sFile, indexOffset, static_cast<size_t>(indexEnd - indexOffset), sIndex))
+			return false;
+		size_t position = 0;
+		while (position < sIndex.size()) {
+			char id;
+			size_t payloadSize;
+			if (sIndex.size() - position < kHeaderSize + 10 || !ParseMemberHeader(sIndex.data() + position, id, payloadSize)
+				|| id != kIndexId || payloadSize % kIndexEntrySize != 0 || sIndex.size() - position < kHeaderSize + payloadSize + 10)
+				return false;
+			const char* pEntry = sIndex.data() + position + kHeaderSize;
+			for (size_t i = 0; i < payloadSize / kIndexEntrySize; ++i, pEntry += kIndexEntrySize)
+				vFrames.push_back({ GetLe(pEntry, 8), GetLe(pEntry + 8, 8) });
+			position += kHeaderSize + payloadSize + 10;
+		}
+		return true;
+	}
+}
+
+namespace LightLogFrameFormat {
+
+	bool ReadFrameIndex(const std::filesystem::path& sPath, std::vector<FrameEntry>& vFrames)
+	{
+		vFrames.clear();
+		std::error_code sError;
+		uint64_t end = std::filesystem::file_size(sPath, sError);
+		std::ifstream sFile(sPath, std::ios::binary);
+		if (sError || !sFile)
+			return false;
+
+		// Sessions are found back to front, each trailer names where its session began
+		std::vector<std::vector<FrameEntry>> vSessions;
+		std::string sTrailer;
+		while (end != 0) {
+			char id;
+			size_t payloadSize;
+			if (end >= kTrailerSize && ReadAt(sFile, end - kTrailerSize, kTrailerSize, sTrailer) && ParseMemberHeader(sTrailer.data(), id, payloadSize)
+				&& id == kTrailerId && payloadSize == 24) {
+				uint64_t indexOffset = GetLe(sTrailer.data() + kHeaderSize, 8);
+				uint64_t sessionStart = GetLe(sTrailer.data() + kHeaderSize + 8, 8);
+				uint64_t frameCount = GetLe(sTrailer.data() + kHeaderSize + 16, 8);
+				std::vector<FrameEntry> vSession;
+				if (sessionStart <= indexOffset && indexOffset <= end - kTrailerSize
+					&& ReadIndexMembers(sFile, indexOffset, end - kTrailerSize, vSession) && vSession.size() == frameCount) {
+					vSessions.push_back(std::move(vSession));
+					end = sessionStart;
+					continue;
+				}
+			}
+			// No usable trailer, the writing process died: walk everything before this point
+			std::vector<FrameEntry> vScanned;
+			if (!ScanFrames(sFile, end, vScanned))
+				return false;
+			vSessions.push_back(std::move(vScanned));
+			break;
+		}
+		for (auto it = vSessions.rbegin(); it != vSessions.rend(); ++it)
+			vFrames.insert(vFrames.end(), it->begin(), it->end());
+		return true;
+	}
+
+#ifdef LIGHTLOG_HAVE_ZLIB
+
+	bool ReadFrame(const std::filesystem::path& sPath, const FrameEntry& sFrame, std::string& sOut)
+	{
+		sOut.clear();
+		std::ifstream sFile(sPath, std::ios::binary);
+		std::string sMember;
+		char id;
+		size_t payloadSize;
+		if (!sFile || !ReadAt(sFile, sFrame.fileOffset, kHeaderSize + kFrameExtraSize, sMember) || !ParseMemberHeader(sMember.data(), id, payloadSize)
+			|| id != kFrameId || payloadSize != kFrameExtraSize)
+			return false;
+		uint64_t memberSize = GetLe(sMember.data() + kHeaderSize, 4);
+		// A damaged size field must not make ReadAt allocate more than the file holds
+		std::error_code sError;
+		uint64_t fileSize = std::filesystem::file_size(sPath, sError);
+		if (sError || memberSize < kHeaderSize + kFrameExtraSize + 8 || memberSize > fileSize - (std::min)(fileSize, sFrame.fileOffset)
+			|| !ReadAt(sFile, sFrame.fileOffset, static_cast<size_t>(memberSize), sMember))
+			return false;
+
+		z_stream sStream{};
+		if (inflateInit2(&sStream, 16 + MAX_WBITS) != Z_OK)
+			return false;
+		sStream.next_in = reinterpret_cast<Bytef*>(&sMember[0]);
+		sStream.avail_in = static_cast<uInt>(sMember.size());
+		// The output grows with what actually inflates, ISIZE of an unverified member is not trusted for the allocation
+		constexpr size_t kInflateChunk = 64u << 10;
+		int result = Z_OK;
+		while (result == Z_OK) {
+			size_t used = sOut.size();
+			sOut.resize(used + kInflateChunk);
+			sStream.next_out = reinterpret_cast<Bytef*>(&sOut[used]);
+			sStream.avail_out = static_cast<uInt>(kInflateChunk);
+			result = inflate(&sStream, Z_NO_FLUSH);
+			sOut.resize(used + kInflateChunk - sStream.avail_out);
+		}
+		// zlib checks the CRC32 and ISIZE of the gzip member, avail_in rejects bytes after it
+		uint64_t expectedSize = GetLe(sMember.data() + sMember.size() - 4, 4);
+		bool bOk = result == Z_STREAM_END && sStream.avail_in == 0 && (sOut.size() & 0xffffffffu) == expectedSize;
+		inflateEnd(&sStream);
+		if (!bOk)
+			sOut.clear();
+		return bOk;
+	}
+
+#else
+
+	bool ReadFrame(const std::filesystem::path&, const FrameEntry&, std::string& sOut)
+	{
+		sOut.clear();
+		return false;
+	}
+
+#endif
+}
+
+#ifdef LIGHTLOG_HAVE_ZLIB
+
+struct LightLogFrameEncoder::DeflateState {
+	z_stream  sStream{};  /*!< Raw deflate, the gzip framing is written by hand */
+};
+
+std::unique_ptr<LightLogFrameEncoder> LightLogFrameEncoder::Create(size_t frameSize, uint64_t fileOffset)
+{
+	std::unique_ptr<LightLogFrameEncoder> pEncoder(new LightLogFrameEncoder(frameSize, fileOffset));
+	pEncoder->pDeflate.reset(new DeflateState());
+	if (deflateInit2(&pEncoder->pDeflate->sStream, kCompressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		pEncoder->pDeflate.reset();
+		return nullptr;
+	}
+	return pEncoder;
+}
+
+LightLogFrameEncoder::~LightLogFrameEncoder()
+{
+	if (pDeflate)
+		deflateEnd(&pDeflate->sStream);
+}
+
+void LightLogFrameEncoder::EndFrame(std::string& sOut)
+{
+	if (sFrameBytes.empty())
+		return;
+
+	size_t memberStart = sOut.size();
+	PutMemberHeader(sOut, kFrameId, kFrameExtraSize);
+	PutLe(sOut, 0, 4);
+	PutLe(sOut, frameTimeUs, 8);
+
+	z_stream& sStream = pDeflate->sStream;
+	deflateReset(&sStream);
+	size_t bodyStart = sOut.size();
+	sOut.resize(bodyStart + deflateBound(&sStream, static_cast<uLong>(sFrameBytes.size())));
+	sStream.next_in = reinterpret_cast<Bytef*>(&sFrameBytes[0]);
+	sStream.avail_in = static_cast<uInt>(sFrameBytes.size());
+	sStream.next_out = reinterpret_cast<Bytef*>(&sOut[bodyStart]);
+	sStream.avail_out = static_cast<uInt>(sOut.size() - bodyStart);
+	// deflateBound leaves room for the whole frame, one call finishes it
+	if (deflate(&sStream, Z_FINISH) != Z_STREAM_END) {
+		sOut.resize(memberStart);
+		sFrameBytes.clear();
+		return;
+	}
+	sOut.resize(bodyStart + sStream.total_out);
+	PutLe(sOut, crc32(0, reinterpret_cast<const Bytef*>(sFrameBytes.data()), static_cast<uInt>(sFrameBytes.size())), 4);
+	PutLe(sOut, sFrameBytes.size(), 4);
+
+	uint64_t memberSize = sOut.size() - memberStart;
+	for (int i = 0; i < 4; ++i)
+		sOut[memberStart + kHeaderSize + i] = static_cast<char>(memberSize >> (8 * i));
+	vFrames.push_back({ fileOffset, frameTimeUs });
+	fileOffset += memberSize;
+	sFrameBytes.clear();
+}
+
+#else
+
+struct LightLogFrameEncoder::DeflateState {};
+
+std::unique_ptr<LightLogFrameEncoder> LightLogFrameEncoder::Create(size_t, uint64_t)
+{
+	return nullptr;
+}
+
+LightLogFrameEncoder::~LightLogFrameEncoder() = default;
+
+void LightLogFrameEncoder::EndFrame(std::string&)
+{
+	sFrameBytes.clear();
+}
+
+#endif
+
+LightLogFrameEncoder::LightLogFrameEncoder(size_t frameSize, uint64_t fileOffset)
+	: frameSize((std::max)(frameSize, static_cast<size_t>(4096))),
+	sessionStart(fileOffset),
+	fileOffset(fileOffset)
+{
+	sFrameBytes.reserve(this->frameSize);
+}
+
+void LightLogFrameEncoder::AppendRecord(const char* pData, size_t size, uint64_t timeUs, std::string& sOut)
+{
+	if (StartsNewFrame(size))
+		EndFrame(sOut);
+	if (sFrameBytes.empty()) {
+		frameTimeUs = timeUs;
+		sFrameOpened = std::chrono::steady_clock::now();
+	}
+	sFrameBytes.append(pData, size);
+	// Also gives a record larger than a frame a frame of its own
+	if (sFrameBytes.size() >= frameSize)
+		EndFrame(sOut);
+}
+
+std::chrono::steady_clock::time_point LightLogFrameEncoder::GetFrameDeadline() const
+{
+	if (sFrameBytes.empty())
+		return std::chrono::steady_clock::time_point::max();
+	return sFrameOpened + kMaxFrameDelay;
+}
+
+void LightLogFrameEncoder::Finish(std::string& sOut)
+{
+	EndFrame(sOut);
+	// A session without frames leaves the file as it was
+	if (vFrames.empty())
+		return;
+
+	uint64_t indexOffset = fileOffset;
+	size_t indexStart = sOut.size();
+	for (size_t first = 0; first < vFrames.size(); first += kIndexEntriesPerMember) {
+		size_t count = (std::min)(kIndexEntriesPerMember, vFrames.size() - first);
+		PutMemberHeader(sOut, kIndexId, count * kIndexEntrySize);
+		for (size_t i = first; i < first + count; ++i) {
+			PutLe(sOut, vFrames[i].fileOffset, 8);
+			PutLe(sOut, vFrames[i].firstTimeUs, 8);
+		}
+		PutEmptyBody(sOut);
+	}
+	PutMemberHeader(sOut, kTrailerId, 24);
+	PutLe(sOut, indexOffset, 8);
+	PutLe(sOut, sessionStart, 8);
+	PutLe(sOut, vFrames.size(), 8);
+	PutEmptyBody(sOut);
+	fileOffset += sOut.size() - indexStart;
+	vFrames.clear();
+}
@@ -0,0 +1,274 @@
+#include "pch.h"
+#include "LightLogIoUring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define LIGHTLOG_HAS_IO_URING 1
+#endif
+#endif
+
+#ifdef LIGHTLOG_HAS_IO_URING
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifdef LIGHTLOG_HAS_IO_URING
+
+namespace {
+
+	constexpr unsigned kRingEntries = 8;
+
+	int SysIoUringSetup(unsigned entries, io_uring_params* pParams)
+	{
+		return static_cast<int>(::syscall(__NR_io_uring_setup, entries, pParams));
+	}
+
+	int SysIoUringEnter(int ringHandle, unsigned toSubmit, unsigned minComplete, unsigned flags)
+	{
+		return static_cast<int>(::syscall(__NR_io_uring_enter, ringHandle, toSubmit, minComplete, flags, nullptr, 0));
+	}
+
+	template <typename T>
+	T* RingField(void* pRing, uint32_t offset)
+	{
+		return reinterpret_cast<T*>(static_cast<char*>(pRing) + offset);
+	}
+}
+
+std::unique_ptr<LightLogIoUring> LightLogIoUring::Create(int fileHandle, size_t bufferSize, LightLogSinkCounters& sCounters)
+{
+	std::unique_ptr<LightLogIoUring> pRing(new LightLogIoUring(fileHandle, bufferSize, sCounters));
+	if (!pRing->Setup())
+		return nullptr;
+
+	// Offsets are explicit from now on, O_APPEND would make the kernel ignore them
+	int flags = ::fcntl(fileHandle, F_GETFL);
+	off_t endOffset = ::lseek(fileHandle, 0, SEEK_END);
+	if (flags < 0 || endOffset < 0 || ::fcntl(fileHandle, F_SETFL, flags & ~O_APPEND) < 0)
+		return nullptr;
+	pRing->nextFileOffset = static_cast<uint64_t>(endOffset);
+	return pRing;
+}
+
+LightLogIoUring::LightLogIoUring(int fileHandle, size_t bufferSize, LightLogSinkCounters& sCounters)
+	: fileHandle(fileHandle),
+	bufferSize(bufferSize),
+	sCounters(sCounters)
+{
+}
+
+bool LightLogIoUring::Setup()
+{
+	io_uring_params sParams;
+	std::memset(&sParams, 0, sizeof(sParams));
+	ringHandle = SysIoUringSetup(kRingEntries, &sParams);
+	if (ringHandle < 0)
+		return false;
+
+	sqRingBytes = sParams.sq_off.array + sParams.sq_entries * sizeof(unsigned);
+	cqRingBytes = sParams.cq_off.cqes + sParams.cq_entries * sizeof(io_uring_cqe);
+	bool bSingleMap = (sParams.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (bSingleMap)
+		sqRingBytes = cqRingBytes = (std::max)(sqRingBytes, cqRingBytes);
+
+	pSqRing = ::mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringHandle, IORING_OFF_SQ_RING);
+	if (pSqRing == MAP_FAILED) {
+		pSqRing = nullptr;
+		return false;
+	}
+	if (bSingleMap) {
+		pCqRing = pSqRing;
+	}
+	else {
+		pCqRing = ::mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringHandle, IORING_OFF_CQ_RING);
+		if (pCqRing == MAP_FAILED) {
+			pCqRing = nullptr;
+			return false;
+		}
+	}
+	sqEntriesBytes = sParams.sq_entries * sizeof(io_uring_sqe);
+	pSqEntries = ::mmap(nullptr, sqEntriesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringHandle, IORING_OFF_SQES);
+	if (pSqEntries == MAP_FAILED) {
+		pSqEntries = nullptr;
+		return false;
+	}
+
+	pSqTail = RingField<unsigned>(pSqRing, sParams.sq_off.tail);
+	pSqArray = RingField<unsigned>(pSqRing, sParams.sq_off.array);
+	sqMask = *RingField<unsigned>(pSqRing, sParams.sq_off.ring_mask);
+	pCqHead = RingField<unsigned>(pCqRing, sParams.cq_off.head);
+	pCqTail = RingField<unsigned>(pCqRing, sParams.cq_off.tail);
+	cqMask = *RingField<unsigned>(pCqRing, sParams.cq_off.ring_mask);
+	pCqEntries = RingField<io_uring_cqe>(pCqRing, sParams.cq_off.cqes);
+
+	for (auto& sBuffer : aBuffers)
+		sBuffer.pBytes.reset(new char[bufferSize]);
+	return true;
+}
+
+LightLogIoUring::~LightLogIoUring()
+{
+	if (pSqEntries)
+		WaitAll();
+	if (pSqEntries)
+		::munmap(pSqEntries, sqEntriesBytes);
+	if (pCqRing && pCqRing != pSqRing)
+		::munmap(pCqRing, cqRingBytes);
+	if (pSqRing)
+		::munmap(pSqRing, sqRingBytes);
+	if (ringHandle >= 0)
+		::close(ringHandle);
+}
+
+char* LightLogIoUring::AcquireBuffer()
+{
+	InFlightBuffer& sBuffer = aBuffers[nextBuffer];
+	nextBuffer = (nextBuffer + 1) % kInFlightBuffers;
+	Reap(false);
+	// All buffers are in flight: the disk is slower than we format, this is the only place we wait
+	while (sBuffer.bInFlight)
+		Reap(true);
+	return sBuffer.pBytes.get();
+}
+
+void LightLogIoUring::Submit(char* pBuffer, size_t size)
+{
+	size_t index = 0;
+	while (aBuffers[index].pBytes.get() != pBuffer)
+		++index;
+	InFlightBuffer& sBuffer = aBuffers[index];
+	sBuffer.fileOffset = nextFileOffset;
+	sBuffer.pendingBytes = size;
+	nextFileOffset += size;
+
+	static_assert(sizeof(iovec) <= sizeof(sBuffer.aIoVec), "InFlightBuffer::aIoVec is too small");
+	iovec* pIoVec = reinterpret_cast<iovec*>(sBuffer.aIoVec);
+	pIoVec->iov_base = pBuffer;
+	pIoVec->iov_len = size;
+
+	// Only this thread produces submissions, the kernel consumes them during io_uring_enter
+	unsigned tail = *pSqTail;
+	unsigned slot = tail & sqMask;
+	io_uring_sqe* pEntry = static_cast<io_uring_sqe*>(pSqEntries) + slot;
+	std::memset(pEntry, 0, sizeof(*pEntry));
+	pEntry->opcode = IORING_OP_WRITEV;
+	pEntry->fd = fileHandle;
+	pEntry->addr = reinterpret_cast<uint64_t>(pIoVec);
+	pEntry->len = 1;
+	pEntry->off = sBuffer.fileOffset;
+	pEntry->user_data = index;
+	pSqArray[slot] = slot;
+	__atomic_store_n(pSqTail, tail + 1, __ATOMIC_RELEASE);
+
+	int consumed;
+	do {
+		consumed = SysIoUringEnter(ringHandle, 1, 0, 0);
+		LightLogSinkCounters::Add(sCounters.writeCalls, 1);
+	} while (consumed < 0 && errno == EINTR);
+	if (consumed < 1) {
+		// The kernel did not take the entry: withdraw it and write the buffer the blocking way
+		__atomic_store_n(pSqTail, tail, __ATOMIC_RELEASE);
+		WriteAt(pBuffer, size, sBuffer.fileOffset);
+		return;
+	}
+	sBuffer.bInFlight = true;
+	++inFlightCount;
+	LightLogSinkCounters::Add(sCounters.asyncWrites, 1);
+}
+
+void LightLogIoUring::WriteNow(const char* pData, size_t size)
+{
+	uint64_t offset = nextFileOffset;
+	nextFileOffset += size;
+	WriteAt(pData, size, offset);
+}
+
+void LightLogIoUring::WaitAll()
+{
+	while (inFlightCount != 0)
+		Reap(true);
+}
+
+void LightLogIoUring::Reap(bool bWait)
+{
+	unsigned head = *pCqHead;
+	if (bWait && head == __atomic_load_n(pCqTail, __ATOMIC_ACQUIRE)) {
+		SysIoUringEnter(ringHandle, 0, 1, IORING_ENTER_GETEVENTS);
+		LightLogSinkCounters::Add(sCounters.writeCalls, 1);
+	}
+
+	while (head != __atomic_load_n(pCqTail, __ATOMIC_ACQUIRE)) {
+		const io_uring_cqe& sEntry = static_cast<io_uring_cqe*>(pCqEntries)[head & cqMask];
+		InFlightBuffer& sBuffer = aBuffers[sEntry.user_data];
+		int result = sEntry.res;
+		++head;
+		__atomic_store_n(pCqHead, head, __ATOMIC_RELEASE);
+
+		if (result < 0) {
+			// Whatever the reason (EAGAIN included), finish the buffer the blocking way
+			WriteAt(sBuffer.pBytes.get(), sBuffer.pendingBytes, sBuffer.fileOffset);
+		}
+		else {
+			size_t written = static_cast<size_t>(result);
+			LightLogSinkCounters::Add(sCounters.bytesWritten, written);
+			if (written < sBuffer.pendingBytes)
+				WriteAt(sBuffer.pBytes.get() + written, sBuffer.pendingBytes - written, sBuffer.fileOffset + written);
+		}
+		sBuffer.bInFlight = false;
+		--inFlightCount;
+	}
+}
+
+void LightLogIoUring::WriteAt(const char* pData, size_t size, uint64_t offset)
+{
+	while (size != 0) {
+		ssize_t written = ::pwrite(fileHandle, pData, size, static_cast<off_t>(offset));
+		LightLogSinkCounters::Add(sCounters.writeCalls, 1);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			LightLogSinkCounters::Add(sCounters.failedWrites, 1);
+			return;
+		}
+		LightLogSinkCounters::Add(sCounters.bytesWritten, static_cast<uint64_t>(written));
+		pData += written;
+		size -= static_cast<size_t>(written);
+		offset += static_cast<uint64_t>(written);
+	}
+}
+
+#else
+
+// io_uring is Linux only, the sink always falls back to write elsewhere
+
+std::unique_ptr<LightLogIoUring> LightLogIoUring::Create(int, size_t, LightLogSinkCounters&)
+{
+	return nullptr;
+}
+
+LightLogIoUring::LightLogIoUring(int fileHandle, size_t bufferSize, LightLogSinkCounters& sCounters)
+	: fileHandle(fileHandle),
+	bufferSize(bufferSize),
+	sCounters(sCounters)
+{
+}
+
+LightLogIoUring::~LightLogIoUring() = default;
+
+char* LightLogIoUring::AcquireBuffer() { return nullptr; }
+
+void LightLogIoUring::Submit(char*, size_t) {}
+
+void LightLogIoUring::WriteNow(const char*, size_t) {}
+
+void LightLogIoUring::WaitAll() {}
+
+#endif
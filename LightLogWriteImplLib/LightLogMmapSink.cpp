@@ -0,0 +1,219 @@
+#include "pch.h"
+#include "LightLogMmapSink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+LightLogMmapSink::LightLogMmapSink(const std::filesystem::path& sPath, size_t segmentSize, LightLogSinkCounters& sCounters)
+	: sBasePath(sPath),
+	segmentSize(segmentSize),
+	sCounters(sCounters)
+{
+}
+
+std::filesystem::path LightLogMmapSink::SegmentPath(const std::filesystem::path& sBasePath, size_t index)
+{
+	if (index == 0)
+		return sBasePath;
+	std::filesystem::path sFileName = sBasePath.stem();
+	sFileName += "." + std::to_string(index);
+	sFileName += sBasePath.extension();
+	return sBasePath.parent_path() / sFileName;
+}
+
+bool LightLogMmapSink::StartsNewSegment(size_t size) const
+{
+	if (!sActive.pMapping)
+		return true;
+	// A segment that is still empty takes the record anyway, it would not fit in the next one either
+	return size > sActive.mappingSize - sActive.used && sActive.mappingOffset + sActive.used != 0;
+}
+
+void LightLogMmapSink::Append(const char* pData, size_t size)
+{
+	while (size != 0) {
+		if (StartsNewSegment(size)) {
+			if (!AdvanceSegment()) {
+				LightLogSinkCounters::Add(sCounters.failedWrites, 1);
+				return;
+			}
+			// The next segment may be a partly filled one from an earlier run, check again
+			continue;
+		}
+		size_t chunk = (std::min)(size, sActive.mappingSize - sActive.used);
+		std::memcpy(sActive.pMapping + sActive.used, pData, chunk);
+		sActive.used += chunk;
+		pData += chunk;
+		size -= chunk;
+		LightLogSinkCounters::Add(sCounters.bytesWritten, chunk);
+	}
+	if (!sPrepared.pMapping && !bPrepareFailed && sActive.used >= sActive.mappingSize / 2)
+		bPrepareFailed = !MapNextSegment(sPrepared);
+}
+
+bool LightLogMmapSink::AdvanceSegment()
+{
+	ReleaseSegment(sActive);
+	bPrepareFailed = false;
+	if (sPrepared.pMapping) {
+		std::swap(sActive, sPrepared);
+		return true;
+	}
+	return MapNextSegment(sActive);
+}
+
+#ifndef _WIN32
+
+namespace {
+
+	size_t PageSize()
+	{
+		static const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		return pageSize;
+	}
+}
+
+std::unique_ptr<LightLogMmapSink> LightLogMmapSink::Create(const std::filesystem::path& sPath, size_t segmentSize, LightLogSinkCounters& sCounters)
+{
+	segmentSize = (std::max)(segmentSize, kMinSegmentSize);
+	segmentSize = (segmentSize + PageSize() - 1) / PageSize() * PageSize();
+	std::unique_ptr<LightLogMmapSink> pSink(new LightLogMmapSink(sPath, segmentSize, sCounters));
+	if (!pSink->MapNextSegment(pSink->sActive))
+		return nullptr;
+	return pSink;
+}
+
+LightLogMmapSink::~LightLogMmapSink()
+{
+	ReleaseSegment(sActive);
+	ReleaseSegment(sPrepared);
+}
+
+bool LightLogMmapSink::MapNextSegment(Segment& sSegment)
+{
+	for (;; ++nextIndex) {
+		sSegment.sPath = SegmentPath(sBasePath, nextIndex);
+		sSegment.fileHandle = ::open(sSegment.sPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (sSegment.fileHandle < 0)
+			return false;
+		struct stat sFileStat;
+		if (::fstat(sSegment.fileHandle, &sFileStat) != 0) {
+			::close(sSegment.fileHandle);
+			sSegment = Segment();
+			return false;
+		}
+		uint64_t fileSize = static_cast<uint64_t>(sFileStat.st_size);
+		sSegment.mappingOffset = fileSize / PageSize() * PageSize();
+		sSegment.used = static_cast<size_t>(fileSize - sSegment.mappingOffset);
+		sSegment.syncedUsed = sSegment.used;
+		if (fileSize < segmentSize)
+			break;
+		// Full from an earlier run, left as it is
+		::close(sSegment.fileHandle);
+		sSegment = Segment();
+	}
+
+	sSegment.mappingSize = static_cast<size_t>(segmentSize - sSegment.mappingOffset);
+	int result = -1;
+#ifdef __linux__
+	result = ::fallocate(sSegment.fileHandle, 0, static_cast<off_t>(sSegment.mappingOffset), static_cast<off_t>(sSegment.mappingSize));
+	if (result != 0 && errno != EOPNOTSUPP) {
+		ReleaseSegment(sSegment);
+		return false;
+	}
+#endif
+	// Sparse file: blocks are allocated on first touch, a full disk then faults with SIGBUS
+	if (result != 0)
+		result = ::ftruncate(sSegment.fileHandle, static_cast<off_t>(segmentSize));
+	if (result != 0) {
+		ReleaseSegment(sSegment);
+		return false;
+	}
+
+	void* pMapping = ::mmap(nullptr, sSegment.mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, sSegment.fileHandle, static_cast<off_t>(sSegment.mappingOffset));
+	if (pMapping == MAP_FAILED) {
+		ReleaseSegment(sSegment);
+		return false;
+	}
+	sSegment.pMapping = static_cast<char*>(pMapping);
+	++nextIndex;
+	LightLogSinkCounters::Add(sCounters.filesOpened, 1);
+	return true;
+}
+
+void LightLogMmapSink::ReleaseSegment(Segment& sSegment)
+{
+	if (sSegment.fileHandle < 0)
+		return;
+	uint64_t dataEnd = sSegment.mappingOffset + sSegment.used;
+	if (sSegment.pMapping) {
+		// Start writeback now, nothing waits for it
+		if (sSegment.used != 0)
+			::msync(sSegment.pMapping, sSegment.used, MS_ASYNC);
+		::munmap(sSegment.pMapping, sSegment.mappingSize);
+	}
+	// Drop the preallocated tail, a segment nothing was ever written to goes away entirely
+	if (::ftruncate(sSegment.fileHandle, static_cast<off_t>(dataEnd)) != 0)
+		LightLogSinkCounters::Add(sCounters.failedWrites, 1);
+	::close(sSegment.fileHandle);
+	if (dataEnd == 0)
+		::unlink(sSegment.sPath.c_str());
+	else if (sSegment.used != sSegment.syncedUsed)
+		vUnsyncedSegments.push_back(sSegment.sPath);
+	sSegment = Segment();
+}
+
+void LightLogMmapSink::Sync()
+{
+	// fsync through any descriptor covers the file's dirty pages, so switched away segments are reopened
+	for (const auto& sPath : vUnsyncedSegments) {
+		int fileHandle = ::open(sPath.c_str(), O_RDONLY | O_CLOEXEC);
+#ifdef __APPLE__
+		if (fileHandle < 0 || ::fsync(fileHandle) != 0)
+#else
+		if (fileHandle < 0 || ::fdatasync(fileHandle) != 0)
+#endif
+			LightLogSinkCounters::Add(sCounters.failedWrites, 1);
+		if (fileHandle >= 0)
+			::close(fileHandle);
+		LightLogSinkCounters::Add(sCounters.syncCalls, 1);
+	}
+	vUnsyncedSegments.clear();
+
+	if (!sActive.pMapping || sActive.used == sActive.syncedUsed)
+		return;
+	size_t syncFrom = sActive.syncedUsed / PageSize() * PageSize();
+	if (::msync(sActive.pMapping + syncFrom, sActive.used - syncFrom, MS_SYNC) != 0)
+		LightLogSinkCounters::Add(sCounters.failedWrites, 1);
+	LightLogSinkCounters::Add(sCounters.syncCalls, 1);
+	sActive.syncedUsed = sActive.used;
+}
+
+#else
+
+// No mmap segments on Windows, the sink falls back to write there
+
+std::unique_ptr<LightLogMmapSink> LightLogMmapSink::Create(const std::filesystem::path&, size_t, LightLogSinkCounters&)
+{
+	return nullptr;
+}
+
+LightLogMmapSink::~LightLogMmapSink() = default;
+
+bool LightLogMmapSink::MapNextSegment(Segment&) { return false; }
+
+void LightLogMmapSink::ReleaseSegment(Segment&) {}
+
+void LightLogMmapSink::Sync() {}
+
+#endif
@@ -0,0 +1,158 @@
+#include "pch.h"
+#include "LightLogRotation.h"
+
+#include <algorithm>
+#include <ctime>
+#include <cwctype>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+	std::tm ToLocalTm(std::time_t sTime)
+	{
+		std::tm sLocalTm;
+#ifdef _WIN32
+		localtime_s(&sLocalTm, &sTime);
+#else
+		localtime_r(&sTime, &sLocalTm);
+#endif
+		return sLocalTm;
+	}
+}
+
+namespace LightLogRotation {
+
+	std::chrono::system_clock::time_point NextDeadline(LogRotationPeriod ePeriod, std::chrono::system_clock::time_point sNow)
+	{
+		if (ePeriod == LogRotationPeriod::Never)
+			return std::chrono::system_clock::time_point::max();
+
+		std::tm sBoundaryTm = ToLocalTm(std::chrono::system_clock::to_time_t(sNow));
+		sBoundaryTm.tm_min = 0;
+		sBoundaryTm.tm_sec = 0;
+		sBoundaryTm.tm_isdst = -1;
+		switch (ePeriod) {
+		case LogRotationPeriod::Hourly:
+			sBoundaryTm.tm_hour += 1;
+			break;
+		case LogRotationPeriod::HalfDay:
+			if (sBoundaryTm.tm_hour < 12) {
+				sBoundaryTm.tm_hour = 12;
+				break;
+			}
+			sBoundaryTm.tm_hour = 0;
+			sBoundaryTm.tm_mday += 1;
+			break;
+		default:
+			sBoundaryTm.tm_hour = 0;
+			sBoundaryTm.tm_mday += 1;
+			break;
+		}
+		// mktime normalizes the overflowing fields and picks the DST offset of the boundary itself
+		auto sDeadline = std::chrono::system_clock::from_time_t(std::mktime(&sBoundaryTm));
+		// Only a repeated hour at the end of DST can land here
+		if (sDeadline <= sNow)
+			sDeadline = sNow + std::chrono::hours(1);
+		return sDeadline;
+	}
+
+	std::wstring PeriodSuffix(LogRotationPeriod ePeriod, std::chrono::system_clock::time_point sNow)
+	{
+		if (ePeriod == LogRotationPeriod::Never)
+			return std::wstring();
+
+		std::tm sTmPartsInfo = ToLocalTm(std::chrono::system_clock::to_time_t(sNow));
+		std::wostringstream sWosStrStream;
+		sWosStrStream << L'_' << std::put_time(&sTmPartsInfo, L"%Y_%m_%d");
+		if (ePeriod == LogRotationPeriod::HalfDay)
+			sWosStrStream << (sTmPartsInfo.tm_hour < 12 ? L"_AM" : L"_PM");
+		else if (ePeriod == LogRotationPeriod::Hourly)
+			sWosStrStream << std::put_time(&sTmPartsInfo, L"_%H");
+		return sWosStrStream.str();
+	}
+
+	std::filesystem::path IndexedPath(const std::filesystem::path& sPath, size_t index)
+	{
+		if (index == 0)
+			return sPath;
+		// A compressed file keeps ".gz" last: app.log.gz -> app-3.log.gz
+		std::filesystem::path sLogFile = sPath.filename();
+		std::filesystem::path sCompressedExtension;
+		if (sLogFile.extension() == ".gz") {
+			sCompressedExtension = sLogFile.extension();
+			sLogFile = sLogFile.stem();
+		}
+		// Not ".": app.1.log is already the first mmap segment of app.log, and "_" would read as part of the date
+		std::filesystem::path sFileName = sLogFile.stem();
+		sFileName += "-" + std::to_string(index);
+		sFileName += sLogFile.extension();
+		sFileName += sCompressedExtension;
+		return sPath.parent_path() / sFileName;
+	}
+
+	bool IsLastingLogFile(const std::wstring& sFileName, const std::wstring& sBaseName)
+	{
+		if (sFileName.size() <= sBaseName.size() || sFileName.compare(0, sBaseName.size(), sBaseName) != 0)
+			return false;
+		// Compressed files count as well: app_2025_06_21_AM.log.gz
+		std::filesystem::path sLogFile(sFileName);
+		if (sLogFile.extension() == L".gz")
+			sLogFile = sLogFile.stem();
+		std::filesystem::path sExtension = sLogFile.extension();
+		if (sExtension != L".log" && sExtension != L".llb")
+			return false;
+		// "_" plus a date, or "." / "-" plus an index for the Never period; "app" must not match "app_server_..."
+		wchar_t next = sFileName[sBaseName.size()];
+		if (next == L'.')
+			return true;
+		return (next == L'_' || next == L'-') && sFileName.size() > sBaseName.size() + 1 && std::iswdigit(sFileName[sBaseName.size() + 1]);
+	}
+
+	void ApplyRetention(const std::filesystem::path& sDirectory, const std::wstring& sBaseName, const std::filesystem::path& sKeepFile,
+		size_t maxFileCount, uint64_t maxTotalBytes)
+	{
+		struct LogFileEntry {
+			std::filesystem::path            sPath;
+			std::filesystem::file_time_type  sModified;
+			uint64_t                         size;
+		};
+
+		std::error_code sError;
+		std::vector<LogFileEntry> vFiles;
+		uint64_t totalBytes = 0;
+		for (std::filesystem::directory_iterator sIt(sDirectory.empty() ? std::filesystem::path(".") : sDirectory, sError), sEnd; !sError && sIt != sEnd; sIt.increment(sError)) {
+			if (!sIt->is_regular_file(sError) || !IsLastingLogFile(sIt->path().filename().wstring(), sBaseName))
+				continue;
+			LogFileEntry sEntry{ sIt->path(), sIt->last_write_time(sError), sIt->file_size(sError) };
+			if (sError)
+				continue;
+			totalBytes += sEntry.size;
+			vFiles.push_back(std::move(sEntry));
+		}
+		std::sort(vFiles.begin(), vFiles.end(), [](const LogFileEntry& a, const LogFileEntry& b) { return a.sModified < b.sModified; });
+
+		if (maxFileCount == 0)
+			maxFileCount = (std::numeric_limits<size_t>::max)();
+		if (maxTotalBytes == 0)
+			maxTotalBytes = (std::numeric_limits<uint64_t>::max)();
+		// The file being written and its mmap segments (keep.1.log, keep.2.log ...) stay
+		std::wstring sKeepName = sKeepFile.filename().wstring();
+		std::wstring sKeepSegmentPrefix = sKeepFile.stem().wstring() + L".";
+		size_t fileCount = vFiles.size();
+		for (const auto& sEntry : vFiles) {
+			if (fileCount <= maxFileCount && totalBytes <= maxTotalBytes)
+				break;
+			std::wstring sName = sEntry.sPath.filename().wstring();
+			if (sName == sKeepName || sName.compare(0, sKeepSegmentPrefix.size(), sKeepSegmentPrefix) == 0)
+				continue;
+			if (std::filesystem::remove(sEntry.sPath, sError)) {
+				--fileCount;
+				totalBytes -= sEntry.size;
+			}
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#include "pch.h"
+#include "LightLogShardedWrite.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+	/**
+		* @brief Number of the calling thread, handed out in the order threads first log
+		*/
+	size_t GetThreadShardSlot()
+	{
+		static std::atomic<size_t> nextThreadSlot{ 0 };
+		thread_local size_t threadSlot = nextThreadSlot.fetch_add(1, std::memory_order_relaxed);
+		return threadSlot;
+	}
+}
+
+LightLogShardedWrite::LightLogShardedWrite(size_t shardCount, LogShardKey eShardKey, size_t maxQueueSize,
+	LogQueueOverflowStrategy strategy, size_t reportInterval, LogWriteQueueMode queueMode)
+	: eShardKey(eShardKey),
+	sequenceCounter{ 0 }
+{
+	shardCount = (std::max)(shardCount, static_cast<size_t>(1));
+	for (size_t i = 0; i < shardCount; ++i) {
+		vShards.emplace_back(new LightLogWrite_Impl(maxQueueSize, strategy, reportInterval, queueMode));
+		vShards.back()->SetSequenceCounter(&sequenceCounter);
+	}
+}
+
+std::filesystem::path LightLogShardedWrite::ShardPath(const std::filesystem::path& sPath, size_t index)
+{
+	std::filesystem::path sFileName = sPath.stem();
+	sFileName += "_shard" + std::to_string(index);
+	sFileName += sPath.extension();
+	return sPath.parent_path() / sFileName;
+}
+
+void LightLogShardedWrite::SetLogsFileName(const std::wstring& sFilename)
+{
+	for (size_t i = 0; i < vShards.size(); ++i)
+		vShards[i]->SetLogsFileName(ShardPath(sFilename, i).wstring());
+}
+
+void LightLogShardedWrite::SetLastingsLogs(const std::wstring& sFilePath, const std::wstring& sBaseName)
+{
+	// Retention of base name "app" would not match "app_shard0_...", each shard only sees its own files
+	for (size_t i = 0; i < vShards.size(); ++i)
+		vShards[i]->SetLastingsLogs(sFilePath, sBaseName + L"_shard" + std::to_wstring(i));
+}
+
+LightLogWrite_Impl& LightLogShardedWrite::Route(std::string_view sTypeVal)
+{
+	size_t key = eShardKey == LogShardKey::Tag ? std::hash<std::string_view>()(sTypeVal) : GetThreadShardSlot();
+	return *vShards[key % vShards.size()];
+}
+
+void LightLogShardedWrite::Flush()
+{
+	for (auto& pShard : vShards)
+		pShard->Flush();
+}
+
+void LightLogShardedWrite::FlushAndWait()
+{
+	// Requested everywhere first, so the shards sync in parallel
+	for (auto& pShard : vShards)
+		pShard->Flush();
+	for (auto& pShard : vShards)
+		pShard->FlushAndWait();
+}
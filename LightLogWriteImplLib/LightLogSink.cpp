@@ -0,0 +1,128 @@
+#include "pch.h"
+#include "LightLogSink.h"
+#include "LightLogWriteImpl.h"
+
+#include <algorithm>
+
+void LightLogStreamSink::Write(const LightLogSinkBatch& sBatch)
+{
+	if (sBatch.sText.empty())
+		return;
+	std::fwrite(sBatch.sText.data(), 1, sBatch.sText.size(), pStream);
+	std::fflush(pStream);
+}
+
+LightLogMemorySink::LightLogMemorySink(size_t capacity)
+	: vLines((std::max)(capacity, static_cast<size_t>(1)))
+{
+}
+
+void LightLogMemorySink::Write(const LightLogSinkBatch& sBatch)
+{
+	std::lock_guard<std::mutex> sLock(pLinesMutex);
+	// Only the lines that survive the batch are copied
+	size_t firstLine = sBatch.LineCount() > vLines.size() ? sBatch.LineCount() - vLines.size() : 0;
+	for (size_t i = firstLine; i < sBatch.LineCount(); ++i) {
+		std::string_view sLine = sBatch.Line(i);
+		if (!sLine.empty() && sLine.back() == '\n')
+			sLine.remove_suffix(1);
+		vLines[nextLine].assign(sLine.data(), sLine.size());
+		nextLine = (nextLine + 1) % vLines.size();
+		lineCount = (std::min)(lineCount + 1, vLines.size());
+	}
+}
+
+std::vector<std::string> LightLogMemorySink::GetLines() const
+{
+	std::lock_guard<std::mutex> sLock(pLinesMutex);
+	std::vector<std::string> vResult;
+	vResult.reserve(lineCount);
+	size_t firstLine = (nextLine + vLines.size() - lineCount) % vLines.size();
+	for (size_t i = 0; i < lineCount; ++i)
+		vResult.push_back(vLines[(firstLine + i) % vLines.size()]);
+	return vResult;
+}
+
+LightLogSinkChannel::LightLogSinkChannel(std::shared_ptr<LightLogSink> pSink, size_t capacity, LogQueueOverflowStrategy eStrategy)
+	: pSink(std::move(pSink)),
+	capacity((std::max)(capacity, static_cast<size_t>(1))),
+	bBlockWhenFull(eStrategy == LogQueueOverflowStrategy::Block)
+{
+	sSinkThread = std::thread(&LightLogSinkChannel::Run, this);
+}
+
+LightLogSinkChannel::~LightLogSinkChannel()
+{
+	Stop();
+}
+
+void LightLogSinkChannel::Post(std::shared_ptr<const LightLogSinkBatch> pBatch)
+{
+	size_t lineCount = pBatch->LineCount();
+	if (lineCount == 0)
+		return;
+	{
+		std::unique_lock<std::mutex> sLock(pQueueMutex);
+		if (bBlockWhenFull) {
+			// queuedLines includes the batch the sink is writing; an oversized batch still goes in once all is written
+			pQueueCondVar.wait(sLock, [&] { return bStopping || queuedLines == 0 || queuedLines + lineCount <= capacity; });
+		}
+		else {
+			while (!qBatches.empty() && queuedLines + lineCount > capacity) {
+				size_t droppedCount = qBatches.front()->LineCount();
+				queuedLines -= droppedCount;
+				droppedLines += droppedCount;
+				qBatches.pop_front();
+			}
+		}
+		if (bStopping)
+			return;
+		qBatches.push_back(std::move(pBatch));
+		queuedLines += lineCount;
+	}
+	pQueueCondVar.notify_all();
+}
+
+void LightLogSinkChannel::Stop()
+{
+	{
+		std::lock_guard<std::mutex> sLock(pQueueMutex);
+		bStopping = true;
+	}
+	pQueueCondVar.notify_all();
+	if (sSinkThread.joinable())
+		sSinkThread.join();
+}
+
+LightLogSinkChannelStats LightLogSinkChannel::GetStats() const
+{
+	std::lock_guard<std::mutex> sLock(pQueueMutex);
+	LightLogSinkChannelStats sStats;
+	sStats.writtenLines = writtenLines;
+	sStats.droppedLines = droppedLines;
+	sStats.queuedLines = queuedLines;
+	return sStats;
+}
+
+void LightLogSinkChannel::Run()
+{
+	std::unique_lock<std::mutex> sLock(pQueueMutex);
+	while (true) {
+		pQueueCondVar.wait(sLock, [this] { return !qBatches.empty() || bStopping; });
+		if (qBatches.empty())
+			break;
+		std::shared_ptr<const LightLogSinkBatch> pBatch = std::move(qBatches.front());
+		qBatches.pop_front();
+		// Counted as queued until written, so a blocked Post waits for the sink, not just the hand-over
+		sLock.unlock();
+		try {
+			pSink->Write(*pBatch);
+		}
+		catch (...) {
+		}
+		sLock.lock();
+		queuedLines -= pBatch->LineCount();
+		writtenLines += pBatch->LineCount();
+		pQueueCondVar.notify_all();
+	}
+}
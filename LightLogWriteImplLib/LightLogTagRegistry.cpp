@@ -0,0 +1,32 @@
+#include "pch.h"
+#include "LightLogTagRegistry.h"
+
+#include <stdexcept>
+
+LightLogTagRegistry::LightLogTagRegistry()
+	: pEntries(new LightLogTagEntry[kMaxTags]),
+	tagCount{ 0 }
+{
+}
+
+LogTagId LightLogTagRegistry::Register(std::string_view sTagName)
+{
+	std::lock_guard<std::mutex> sLock(pRegisterMutex);
+	std::string sKey(sTagName);
+	auto it = mTagIds.find(sKey);
+	if (it != mTagIds.end())
+		return it->second;
+
+	uint32_t index = tagCount.load(std::memory_order_relaxed);
+	if (index >= kMaxTags)
+		throw std::length_error("LightLogTagRegistry: too many distinct log tags");
+
+	LightLogTagEntry& sEntry = pEntries[index];
+	sEntry.sTagName = sKey;
+	sEntry.sLinePrefix = sKey + "-//>>>";
+
+	LogTagId tagId{ index + 1 };
+	mTagIds.emplace(std::move(sKey), tagId);
+	tagCount.store(index + 1, std::memory_order_release);
+	return tagId;
+}
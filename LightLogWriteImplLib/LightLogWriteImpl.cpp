@@ -1,32 +1,173 @@
 #include "LightLogWriteImpl.h"
 #include "UniConv.h"
 #include "pch.h"
+#include "LightLogMmapSink.h"
 
+#include <charconv>
+#include <stdexcept>
 
-LightLogWrite_Impl::LightLogWrite_Impl(size_t maxQueueSize, LogQueueOverflowStrategy strategy, size_t reportInterval)
-  :	kMaxQueueSize(maxQueueSize),
+namespace {
+
+	/**
+		* @brief One staging ring registered by the current thread for one logger instance
+		*/
+	struct ThreadStagingSlot {
+		uint64_t                               loggerId;  /*!< LightLogWrite_Impl::kInstanceId */
+		std::shared_ptr<LightLogStagingBuffer> pBuffer;   /*!< Ring shared with the write thread */
+	};
+
+	/**
+		* @brief Thread local list of staging rings, hands leftovers to the write thread on thread exit
+		*/
+	struct ThreadStagingRegistry {
+		std::vector<ThreadStagingSlot> slots;
+
+		~ThreadStagingRegistry()
+		{
+			for (auto& slot : slots)
+				slot.pBuffer->bProducerExited.store(true, std::memory_order_release);
+		}
+	};
+
+	thread_local ThreadStagingRegistry tlsStagingRegistry;
+
+	std::atomic<uint64_t> gLoggerInstanceCounter{ 0 };
+
+	constexpr size_t kDefaultStagingCapacity = 8192;
+
+	/**
+		* @brief Per thread UTF-8 buffers of the wide and UTF-16 overloads, reused so converting does not allocate
+		*/
+	thread_local std::string tlsUtf8TagBuffer;
+	thread_local std::string tlsUtf8MessageBuffer;
+}
+
+void LightLogWriteInfo::AssignContent(std::string_view sTagName, std::string_view sContent)
+{
+	pLogFormatVal = nullptr;
+	char* pBody = AssignPayload(sTagName, sContent.size());
+	if (!sContent.empty())
+		std::memcpy(pBody, sContent.data(), sContent.size());
+}
+
+void LightLogWriteInfo::AssignContent(LogTagId registeredTag, std::string_view sContent)
+{
+	AssignContent(std::string_view(), sContent);
+	tagId = registeredTag;
+}
+
+char* LightLogWriteInfo::AssignDeferred(std::string_view sTagName, const wchar_t* pszFormat, size_t bodySize)
+{
+	pLogFormatVal = pszFormat;
+	return AssignPayload(sTagName, bodySize);
+}
+
+char* LightLogWriteInfo::AssignDeferred(LogTagId registeredTag, const wchar_t* pszFormat, size_t bodySize)
+{
+	char* pBody = AssignDeferred(std::string_view(), pszFormat, bodySize);
+	tagId = registeredTag;
+	return pBody;
+}
+
+char* LightLogWriteInfo::AssignPayload(std::string_view sTagName, size_t bodySize)
+{
+	tagId = kNoLogTagId;
+	sequence = 0;
+	enqueueTicks = LightLogClock::ReadTicks();
+	tagBytes = static_cast<uint32_t>(sTagName.size());
+	bodyBytes = static_cast<uint32_t>(bodySize);
+
+	char* pPayload = aInlineBytes;
+	if (static_cast<size_t>(tagBytes) + bodyBytes > kInlineCapacity) {
+		// Spill path: only oversized entries reach the allocator
+		pSpillBytes = new char[static_cast<size_t>(tagBytes) + bodyBytes];
+		pPayload = pSpillBytes;
+	}
+	if (tagBytes != 0)
+		std::memcpy(pPayload, sTagName.data(), tagBytes);
+	return pPayload + tagBytes;
+}
+
+void LightLogWriteInfo::ReleaseSpill()
+{
+	delete[] pSpillBytes;
+	pSpillBytes = nullptr;
+	tagBytes = 0;
+	bodyBytes = 0;
+}
+
+LightLogWrite_Impl::LightLogWrite_Impl(size_t maxQueueSize, LogQueueOverflowStrategy strategy, size_t reportInterval, LogWriteQueueMode queueMode)
+  :	pLogFileSink(sSinkCounters),
+	kMaxQueueSize(maxQueueSize),
 	discardCount(0),
 	lastReportedDiscardCount(0),
 	bIsStopLogging{ false },
 	queueFullStrategy(strategy),
 	reportInterval(reportInterval),
-	bHasLogLasting{ false } 
+	bHasLogLasting{ false },
+	eQueueMode(queueMode),
+	kInstanceId(++gLoggerInstanceCounter),
+	stagingGeneration{ 0 },
+	stagingCapacity{ kDefaultStagingCapacity },
+	bStagingWriterParked{ false },
+	eOutputFormat{ LogOutputFormat::Text },
+	kOverflowTagId(sTagRegistry.Register("LOG_OVERFLOW")),
+	eMinLogLevel{ LogLevel::Trace },
+	maxWriteBatchSize{ 0 },
+	pSequenceCounter{ nullptr },
+	eOpenFileFormat{ LogOutputFormat::Text },
+	writeBufferSize{ LightLogFileSink::kDefaultBufferSize },
+	eFileSinkMode{ LogFileSinkMode::Write },
+	mmapSegmentSize{ LightLogFileSink::kDefaultSegmentSize },
+	eStreamCompression{ LogCompression::None },
+	streamFrameSize{ LightLogFrameFormat::kDefaultFrameSize },
+	syncIntervalMs{ 0 },
+	eSyncLevel{ LogLevel::Off },
+	syncRequestCount{ 0 },
+	completedSyncTicket(0),
+	bSyncWriterExited(false),
+	bUnsyncedWrites(false),
+	sRotationDeadline(std::chrono::system_clock::time_point::max()),
+	rotationMaxBytes((std::numeric_limits<uint64_t>::max)()),
+	currentFileBytes(0),
+	rotationIndex(0),
+	sRotationCheckAt(std::chrono::system_clock::time_point::max()),
+	rotationCheckBytes((std::numeric_limits<uint64_t>::max)()),
+	nextLogSinkId(1),
+	logSinkGeneration{ 0 },
+	writerSinkGeneration(0)
 {
+	// Only the write thread pops from a staging ring, a producer finding it full cannot drop the oldest entry
+	if (queueMode == LogWriteQueueMode::ThreadLocalStaging && strategy == LogQueueOverflowStrategy::DropOldest)
+		throw std::invalid_argument("LightLogWrite_Impl: ThreadLocalStaging requires LogQueueOverflowStrategy::Block");
 	sWrittenThreads = std::thread(&LightLogWrite_Impl::RunWriteThread, this);
 }
 
 LightLogWrite_Impl::~LightLogWrite_Impl()
 {
 	CloseLogStream();
+	{
+		// A file prepared for a rotation that never came is not left behind empty
+		sFileWorker.WaitIdle();
+		std::lock_guard<std::mutex> sPreparedLock(pPreparedMutex);
+		DiscardPreparedFile();
+	}
+	{
+		// Attached sinks write what the last batches handed them
+		std::lock_guard<std::mutex> sSinkLock(pLogSinkMutex);
+		for (auto& sLogSink : vLogSinks)
+			sLogSink.pChannel->Stop();
+	}
+	std::lock_guard<std::mutex> sLock(pStagingMutex);
+	for (auto& pBuffer : pStagingBuffers)
+		pBuffer->bLoggerClosed.store(true, std::memory_order_release);
 }
 
 void LightLogWrite_Impl::SetLogsFileName(const std::wstring& sFilename)
 {
-	std::lock_guard<std::mutex> sWriteLock(pLogWriteMutex);
-	if (pLogFileStream.is_open())
-		pLogFileStream.close();
+	std::lock_guard<std::mutex> sFileLock(pLogFileMutex);
 	ChecksDirectory(sFilename); 
-	pLogFileStream.open(sFilename, std::ios::app);
+	OpenLogFileSink(sFilename);
 }
 
 void LightLogWrite_Impl::SetLogsFileName(const std::string& sFilename)
@@ -44,10 +185,11 @@ void LightLogWrite_Impl::SetLogsFileName(const std::u16string& sFilename)
 
 void LightLogWrite_Impl::SetLastingsLogs(const std::wstring& sFilePath, const std::wstring& sBaseName)
 {
+	std::lock_guard<std::mutex> sFileLock(pLogFileMutex);
 	sLogLastingDir = sFilePath;
 	sLogsBasedName = sBaseName;
 	bHasLogLasting = true;
-	CreateLogsFile();
+	CreateLogsFile(std::chrono::system_clock::now());
 }
 
 void LightLogWrite_Impl::SetLastingsLogs(const std::u16string& sFilePath, const std::u16string& sBaseName)
@@ -60,18 +202,77 @@ void LightLogWrite_Impl::SetLastingsLogs(const std::string& sFilePath, const std
 	SetLastingsLogs(UniConv::GetInstance()->LocaleToWideString(sFilePath), UniConv::GetInstance()->LocaleToWideString(sBaseName));
 }
 
+void LightLogWrite_Impl::WriteLogContent(std::string_view sTypeVal, std::string_view sMessage)
+{
+	LightLogWriteInfo sLogMessageInf;
+	sLogMessageInf.AssignContent(sTypeVal, sMessage);
+	EnqueueLogRecord(std::move(sLogMessageInf));
+}
+
 void LightLogWrite_Impl::WriteLogContent(const std::wstring& sTypeVal, const std::wstring& sMessage)
+{
+	tlsUtf8MessageBuffer.clear();
+	AppendUtf8(tlsUtf8MessageBuffer, sMessage);
+	WriteLogContent(ConvertTagToUtf8(sTypeVal), tlsUtf8MessageBuffer);
+}
+
+void LightLogWrite_Impl::WriteLogContent(LogTagId tagId, std::string_view sMessage)
+{
+	LightLogWriteInfo sLogMessageInf;
+	sLogMessageInf.AssignContent(tagId, sMessage);
+	EnqueueLogRecord(std::move(sLogMessageInf));
+}
+
+void LightLogWrite_Impl::WriteLogContent(LogTagId tagId, const std::wstring& sMessage)
+{
+	tlsUtf8MessageBuffer.clear();
+	AppendUtf8(tlsUtf8MessageBuffer, sMessage);
+	WriteLogContent(tagId, std::string_view(tlsUtf8MessageBuffer));
+}
+
+LogTagId LightLogWrite_Impl::RegisterTag(std::string_view sTagName)
+{
+	return sTagRegistry.Register(sTagName);
+}
+
+LogTagId LightLogWrite_Impl::RegisterTag(const std::wstring& sTagName)
+{
+	return sTagRegistry.Register(ConvertTagToUtf8(sTagName));
+}
+
+uint64_t LightLogWrite_Impl::GetTagLogCount(LogTagId tagId) const
+{
+	if (!sTagRegistry.Contains(tagId))
+		return 0;
+	return sTagRegistry.Get(tagId).writtenCount.load(std::memory_order_relaxed);
+}
+
+std::string_view LightLogWrite_Impl::ConvertTagToUtf8(std::wstring_view sTypeVal)
+{
+	tlsUtf8TagBuffer.clear();
+	AppendUtf8(tlsUtf8TagBuffer, sTypeVal);
+	return tlsUtf8TagBuffer;
+}
+
+void LightLogWrite_Impl::EnqueueLogRecord(LightLogWriteInfo&& sLogMessageInf)
 {
 	bool bNeedReport = false;
 	size_t currentDiscard = 0;
 	static thread_local bool inErrorReport = false;
 
-	if (queueFullStrategy == LogQueueOverflowStrategy::Block) {
+	// Taken before queuing, shards of a LightLogShardedWrite are merged by it
+	if (std::atomic<uint64_t>* pCounter = pSequenceCounter.load(std::memory_order_relaxed))
+		sLogMessageInf.sequence = pCounter->fetch_add(1, std::memory_order_relaxed) + 1;
+
+	if (eQueueMode == LogWriteQueueMode::ThreadLocalStaging) {
+		PushStagingLog(std::move(sLogMessageInf));
+	}
+	else if (queueFullStrategy == LogQueueOverflowStrategy::Block) {
 		std::unique_lock<std::mutex> sWriteLock(pLogWriteMutex);
 		// std::wcerr << L"[WriteLogContent] Try push (Block), queue size: " <<
 		// pLogWriteQueue.size() << std::endl;
 		pWrittenCondVar.wait(sWriteLock, [this] { return pLogWriteQueue.size() < kMaxQueueSize; });
-		pLogWriteQueue.push({ sTypeVal, sMessage });
+		pLogWriteQueue.push(std::move(sLogMessageInf));
 		// std::wcerr << L"[WriteLogContent] Pushed (Block), queue size: " <<
 		// pLogWriteQueue.size() << std::endl;
 	}
@@ -82,6 +283,7 @@ void LightLogWrite_Impl::WriteLogContent(const std::wstring& sTypeVal, const std
 		if (pLogWriteQueue.size() >= kMaxQueueSize) {
 			// std::wcerr << L"[WriteLogContent] Drop oldest, queue full: " <<
 			// pLogWriteQueue.size() << std::endl;
+			pLogWriteQueue.front().ReleaseSpill();
 			pLogWriteQueue.pop();
 			++discardCount;
 			if (discardCount - lastReportedDiscardCount >= reportInterval) {
@@ -90,28 +292,28 @@ void LightLogWrite_Impl::WriteLogContent(const std::wstring& sTypeVal, const std
 				lastReportedDiscardCount.store(discardCount.load());
 			}
 		}
-		pLogWriteQueue.push({ sTypeVal, sMessage });
+		pLogWriteQueue.push(std::move(sLogMessageInf));
 		// std::wcout << L"[WriteLogContent] Pushed (DropOldest), queue size: " <<
 		// pLogWriteQueue.size() << std::endl;
 	}
-	pWrittenCondVar.notify_one();
+	if (eQueueMode == LogWriteQueueMode::SharedQueue)
+		pWrittenCondVar.notify_one();
 	if (bNeedReport && !inErrorReport) {
 		inErrorReport = true;
-		std::wstring overflowMsg = L"The log queue overflows and has been discarded " + std::to_wstring(currentDiscard) + L" logs";
+		std::string overflowMsg = "The log queue overflows and has been discarded " + std::to_string(currentDiscard) + " logs";
 		// std::wcerr << L"[WriteLogContent] Report overflow: " << overflowMsg << std::endl;
-		WriteLogContent(L"LOG_OVERFLOW", overflowMsg);
+		WriteLogContent(kOverflowTagId, overflowMsg);
 		inErrorReport = false;
 	}
 }
 
-void LightLogWrite_Impl::WriteLogContent(const std::string& sTypeVal, const std::string& sMessage)
-{
-	WriteLogContent(UniConv::GetInstance()->LocaleToWideString(sTypeVal), UniConv::GetInstance()->LocaleToWideString(sMessage));
-}
-
 void LightLogWrite_Impl::WriteLogContent(const std::u16string& sTypeVal, const std::u16string& sMessage)
 {
-	WriteLogContent(UniConv::GetInstance()->U16StringToWString(sTypeVal), UniConv::GetInstance()->U16StringToWString(sMessage));
+	tlsUtf8TagBuffer.clear();
+	AppendUtf8(tlsUtf8TagBuffer, sTypeVal);
+	tlsUtf8MessageBuffer.clear();
+	AppendUtf8(tlsUtf8MessageBuffer, sMessage);
+	WriteLogContent(std::string_view(tlsUtf8TagBuffer), std::string_view(tlsUtf8MessageBuffer));
 }
 
 size_t LightLogWrite_Impl::GetDiscardCount() const
@@ -124,24 +326,303 @@ void LightLogWrite_Impl::ResetDiscardCount()
 	discardCount = 0;
 }
 
-std::wstring LightLogWrite_Impl::BuildLogFileOut()
+void LightLogWrite_Impl::SetLogOutputFormat(LogOutputFormat eFormat)
 {
-	std::tm sTmPartsInfo = GetCurrsTimerTm();
-	std::wostringstream sWosStrStream;
+	eOutputFormat = eFormat;
+}
+
+void LightLogWrite_Impl::SetWriteBufferSize(size_t bufferSize)
+{
+	writeBufferSize.store(bufferSize, std::memory_order_relaxed);
+}
+
+void LightLogWrite_Impl::SetFileSinkMode(LogFileSinkMode eMode)
+{
+	eFileSinkMode.store(eMode, std::memory_order_relaxed);
+}
+
+void LightLogWrite_Impl::SetMmapSegmentSize(size_t segmentSize)
+{
+	mmapSegmentSize.store(segmentSize, std::memory_order_relaxed);
+}
+
+void LightLogWrite_Impl::SetStreamCompression(LogCompression eCompression, size_t frameSize)
+{
+	streamFrameSize.store(frameSize, std::memory_order_relaxed);
+	eStreamCompression.store(eCompression, std::memory_order_relaxed);
+}
+
+void LightLogWrite_Impl::SetDurabilityPolicy(const LogDurabilityPolicy& sPolicy)
+{
+	syncIntervalMs.store(sPolicy.syncIntervalMs, std::memory_order_relaxed);
+	eSyncLevel.store(sPolicy.eSyncLevel, std::memory_order_relaxed);
+	// A write thread parked without a deadline picks up the new interval
+	pWrittenCondVar.notify_all();
+}
+
+LogDurabilityPolicy LightLogWrite_Impl::GetDurabilityPolicy() const
+{
+	LogDurabilityPolicy sPolicy;
+	sPolicy.syncIntervalMs = syncIntervalMs.load(std::memory_order_relaxed);
+	sPolicy.eSyncLevel = eSyncLevel.load(std::memory_order_relaxed);
+	return sPolicy;
+}
+
+void LightLogWrite_Impl::Flush()
+{
+	RequestSync();
+}
+
+void LightLogWrite_Impl::FlushAndWait()
+{
+	uint64_t ticket = RequestSync();
+	std::unique_lock<std::mutex> sLock(pSyncMutex);
+	pSyncCondVar.wait(sLock, [&] { return completedSyncTicket >= ticket || bSyncWriterExited; });
+}
+
+void LightLogWrite_Impl::SetRotationPolicy(const LogRotationPolicy& sPolicy)
+{
+	// Destroyed after the lock is released, it finishes the compressions it has queued first
+	std::unique_ptr<LightLogBackgroundWorker> pOldCompressionWorker;
+	std::lock_guard<std::mutex> sFileLock(pLogFileMutex);
+	if (sPolicy.compressionThreads != sRotationPolicy.compressionThreads)
+		pOldCompressionWorker = std::move(pCompressionWorker);
+	sRotationPolicy = sPolicy;
+	if (bHasLogLasting)
+		CreateLogsFile(std::chrono::system_clock::now());
+}
 
-	sWosStrStream << std::put_time(&sTmPartsInfo, L"%Y_%m_%d") << (sTmPartsInfo.tm_hour >= 12 ? L"_AM" : L"_PM") << L".log";
+LogRotationPolicy LightLogWrite_Impl::GetRotationPolicy()
+{
+	std::lock_guard<std::mutex> sFileLock(pLogFileMutex);
+	return sRotationPolicy;
+}
+
+uint64_t LightLogWrite_Impl::RequestSync()
+{
+	uint64_t ticket;
+	{
+		// Taken so the write thread cannot miss the wake up between checking for work and parking
+		std::lock_guard<std::mutex> sLock(pLogWriteMutex);
+		ticket = syncRequestCount.fetch_add(1, std::memory_order_release) + 1;
+	}
+	pWrittenCondVar.notify_all();
+	return ticket;
+}
 
-	bLastingTmTags = (sTmPartsInfo.tm_hour > 12);
+void LightLogWrite_Impl::SyncLogFile(uint64_t syncTicket, bool bCaughtUp)
+{
+	bool bRequested = bCaughtUp && syncTicket != completedSyncTicket;
+	bool bIntervalDue = false;
+	if (bUnsyncedWrites) {
+		uint32_t intervalMs = syncIntervalMs.load(std::memory_order_relaxed);
+		bIntervalDue = intervalMs != 0 && std::chrono::steady_clock::now() - sUnsyncedSince >= std::chrono::milliseconds(intervalMs);
+	}
+	if (!bRequested && !bIntervalDue)
+		return;
+
+	pLogFileSink.Sync();
+	bUnsyncedWrites = false;
+	if (bRequested) {
+		// Every ticket up to syncTicket was handed out before its records were looked for: all are served
+		std::lock_guard<std::mutex> sLock(pSyncMutex);
+		completedSyncTicket = syncTicket;
+		pSyncCondVar.notify_all();
+	}
+}
+
+void LightLogWrite_Impl::FinishSyncRequests()
+{
+	uint64_t syncTicket = syncRequestCount.load(std::memory_order_acquire);
+	if (HasDurabilityPolicy() || syncTicket != completedSyncTicket)
+		pLogFileSink.Sync();
+	std::lock_guard<std::mutex> sLock(pSyncMutex);
+	completedSyncTicket = syncTicket;
+	bSyncWriterExited = true;
+	pSyncCondVar.notify_all();
+}
+
+LightLogSinkStats LightLogWrite_Impl::GetSinkStats() const
+{
+	return pLogFileSink.GetStats();
+}
+
+size_t LightLogWrite_Impl::AddLogSink(std::shared_ptr<LightLogSink> pSink, size_t capacity, LogQueueOverflowStrategy eStrategy)
+{
+	std::lock_guard<std::mutex> sSinkLock(pLogSinkMutex);
+	size_t sinkId = nextLogSinkId++;
+	vLogSinks.push_back({ sinkId, std::make_shared<LightLogSinkChannel>(std::move(pSink), capacity, eStrategy) });
+	logSinkGeneration.fetch_add(1, std::memory_order_release);
+	return sinkId;
+}
+
+bool LightLogWrite_Impl::RemoveLogSink(size_t sinkId)
+{
+	std::shared_ptr<LightLogSinkChannel> pChannel;
+	{
+		std::lock_guard<std::mutex> sSinkLock(pLogSinkMutex);
+		auto it = std::find_if(vLogSinks.begin(), vLogSinks.end(), [&](const AttachedLogSink& sLogSink) { return sLogSink.sinkId == sinkId; });
+		if (it == vLogSinks.end())
+			return false;
+		pChannel = std::move(it->pChannel);
+		vLogSinks.erase(it);
+		logSinkGeneration.fetch_add(1, std::memory_order_release);
+	}
+	// The write thread may still post to it until it sees the new generation, Post ignores that then
+	pChannel->Stop();
+	return true;
+}
+
+LightLogSinkChannelStats LightLogWrite_Impl::GetLogSinkStats(size_t sinkId) const
+{
+	std::lock_guard<std::mutex> sSinkLock(pLogSinkMutex);
+	for (const auto& sLogSink : vLogSinks)
+		if (sLogSink.sinkId == sinkId)
+			return sLogSink.pChannel->GetStats();
+	return LightLogSinkChannelStats();
+}
+
+void LightLogWrite_Impl::BeginSinkBatch()
+{
+	if (writerSinkGeneration != logSinkGeneration.load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> sSinkLock(pLogSinkMutex);
+		vWriterSinkChannels.clear();
+		for (const auto& sLogSink : vLogSinks)
+			vWriterSinkChannels.push_back(sLogSink.pChannel);
+		writerSinkGeneration = logSinkGeneration.load(std::memory_order_relaxed);
+	}
+	if (vWriterSinkChannels.empty()) {
+		pSinkBatch.reset();
+		return;
+	}
+	// An unpublished batch is empty still, a published one belongs to the channels now
+	if (!pSinkBatch)
+		pSinkBatch = std::make_shared<LightLogSinkBatch>();
+}
+
+void LightLogWrite_Impl::PublishSinkBatch()
+{
+	if (!pSinkBatch || pSinkBatch->LineCount() == 0)
+		return;
+	for (auto& pChannel : vWriterSinkChannels)
+		pChannel->Post(pSinkBatch);
+	pSinkBatch.reset();
+}
+
+void LightLogWrite_Impl::SetLogLevel(LogLevel eLevel)
+{
+	eMinLogLevel.store(eLevel, std::memory_order_relaxed);
+}
+
+LogLevel LightLogWrite_Impl::GetLogLevel() const
+{
+	return eMinLogLevel.load(std::memory_order_relaxed);
+}
+
+void LightLogWrite_Impl::SetSequenceCounter(std::atomic<uint64_t>* pCounter)
+{
+	pSequenceCounter.store(pCounter, std::memory_order_relaxed);
+}
+
+void LightLogWrite_Impl::SetMaxWriteBatchSize(size_t maxBatchSize)
+{
+	maxWriteBatchSize.store(maxBatchSize, std::memory_order_relaxed);
+}
+
+void LightLogWrite_Impl::SetStagingBufferCapacity(size_t capacity)
+{
+	stagingCapacity = capacity ? capacity : kDefaultStagingCapacity;
+}
+
+void LightLogWrite_Impl::PushStagingLog(LightLogWriteInfo&& sLogMessageInf)
+{
+	LightLogStagingBuffer* pBuffer = GetThreadStagingBuffer();
+
+	// The constructor only accepts Block in this mode
+	while (!pBuffer->sRingQueue.push(std::move(sLogMessageInf))) {
+		if (bIsStopLogging) {
+			sLogMessageInf.ReleaseSpill();
+			return;
+		}
+		std::this_thread::yield();
+	}
+
+	// Pairs with the fence in RunStagingWriteThread: either the write thread sees the entry
+	// before parking or we see it parked and wake it. The mutex is only taken when it is idle.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (bStagingWriterParked.load(std::memory_order_relaxed)) {
+		std::lock_guard<std::mutex> sLock(pLogWriteMutex);
+		pWrittenCondVar.notify_one();
+	}
+}
+
+LightLogStagingBuffer* LightLogWrite_Impl::GetThreadStagingBuffer()
+{
+	auto& slots = tlsStagingRegistry.slots;
+	for (auto it = slots.begin(); it != slots.end(); ) {
+		if (it->loggerId == kInstanceId)
+			return it->pBuffer.get();
+		if (it->pBuffer->bLoggerClosed.load(std::memory_order_acquire))
+			it = slots.erase(it);
+		else
+			++it;
+	}
+
+	auto pBuffer = std::make_shared<LightLogStagingBuffer>(stagingCapacity.load());
+	{
+		std::lock_guard<std::mutex> sLock(pStagingMutex);
+		pStagingBuffers.push_back(pBuffer);
+		++stagingGeneration;
+	}
+	slots.push_back({ kInstanceId, pBuffer });
+	return pBuffer.get();
+}
+
+std::filesystem::path LightLogWrite_Impl::PeriodLogFilePath(std::chrono::system_clock::time_point sNow) const
+{
+	std::wostringstream sWosStrStream;
+	sWosStrStream << LightLogRotation::PeriodSuffix(sRotationPolicy.ePeriod, sNow)
+		<< (eOutputFormat == LogOutputFormat::Binary ? L".llb" : L".log");
 
 	std::filesystem::path sLotOutPaths = sLogLastingDir;
-	std::filesystem::path sLogOutFiles = sLotOutPaths / (sLogsBasedName + sWosStrStream.str());
+	std::filesystem::path sLogFilePath = sLotOutPaths / (sLogsBasedName + sWosStrStream.str());
+	// Written compressed already, the name says so
+	LogCompression eCompression = eStreamCompression.load(std::memory_order_relaxed);
+	if (eCompression != LogCompression::None && LightLogCompression::IsAvailable(eCompression))
+		sLogFilePath = LightLogCompression::CompressedPath(sLogFilePath, eCompression);
+	return sLogFilePath;
+}
+
+uint64_t LightLogWrite_Impl::ExistingLogFileBytes(const std::filesystem::path& sPath) const
+{
+	// A prepared mmap file is preallocated already, its size on disk says nothing
+	if (sPreparedFile.pSink && sPath.wstring() == sPreparedFile.sFileName)
+		return sPreparedFile.fileBytes;
+	std::error_code sError;
+	uint64_t fileBytes = std::filesystem::file_size(sPath, sError);
+	return sError ? 0 : fileBytes;
+}
+
+std::wstring LightLogWrite_Impl::BuildLogFileOut(std::chrono::system_clock::time_point sNow)
+{
+	std::filesystem::path sLogOutFiles = PeriodLogFilePath(sNow);
+	sRotationDeadline = LightLogRotation::NextDeadline(sRotationPolicy.ePeriod, sNow);
 
-	return sLogOutFiles.wstring();
+	if (sLogOutFiles.wstring() != sPeriodFileName) {
+		sPeriodFileName = sLogOutFiles.wstring();
+		rotationIndex = 0;
+	}
+	if (sRotationPolicy.maxFileBytes == 0)
+		return sLogOutFiles.wstring();
+	// Files filled by an earlier run of this period are skipped
+	while (ExistingLogFileBytes(LightLogRotation::IndexedPath(sLogOutFiles, rotationIndex)) >= sRotationPolicy.maxFileBytes)
+		++rotationIndex;
+	return LightLogRotation::IndexedPath(sLogOutFiles, rotationIndex).wstring();
 }
 
 void LightLogWrite_Impl::CloseLogStream()
 {
-	WriteLogContent(L"<================================              Stop log write thread    ", L"================================>");
+	WriteLogContent("<================================              Stop log write thread    ", "================================>");
 	bIsStopLogging = true;
 	pWrittenCondVar.notify_all();
 	
@@ -149,42 +630,376 @@ void LightLogWrite_Impl::CloseLogStream()
 		sWrittenThreads.join();
 }
 
-void LightLogWrite_Impl::CreateLogsFile()
+void LightLogWrite_Impl::CreateLogsFile(std::chrono::system_clock::time_point sNow)
 {
-	std::wstring sOutFileName = BuildLogFileOut();
-	std::lock_guard<std::mutex> sLock(pLogWriteMutex);
-	ChecksDirectory(sOutFileName);
-	pLogFileStream.close(); 
-	pLogFileStream.open(sOutFileName, std::ios::app);
-	pLogFileStream.imbue(std::locale(std::locale(), new std::codecvt_utf8_utf16<wchar_t>));
+	// Waits only if sFileWorker is opening the prepared file right now
+	std::lock_guard<std::mutex> sPreparedLock(pPreparedMutex);
+	sPreparingFileName.clear();
+	std::wstring sOutFileName = BuildLogFileOut(sNow);
+	// Measured before opening, an mmap segment is preallocated to its full size
+	currentFileBytes = ExistingLogFileBytes(sOutFileName);
+	rotationMaxBytes = sRotationPolicy.maxFileBytes != 0 ? sRotationPolicy.maxFileBytes : (std::numeric_limits<uint64_t>::max)();
+	sRotationCheckAt = sRotationDeadline != std::chrono::system_clock::time_point::max() ? sRotationDeadline - kPreopenLead : sRotationDeadline;
+	rotationCheckBytes = rotationMaxBytes != (std::numeric_limits<uint64_t>::max)() ? rotationMaxBytes - rotationMaxBytes / 8 : rotationMaxBytes;
+	if (sPreparedFile.pSink && sPreparedFile.sFileName == sOutFileName) {
+		OpenLogFileSink(sOutFileName, sPreparedFile.pSink.get());
+		sPreparedFile = PreparedLogFile();
+	}
+	else {
+		DiscardPreparedFile();
+		ChecksDirectory(sOutFileName);
+		OpenLogFileSink(sOutFileName);
+	}
+	if (!sLastingFileName.empty() && sLastingFileName != sOutFileName)
+		CompressClosedFile(sLastingFileName);
+	sLastingFileName = sOutFileName;
+
+	if (sRotationPolicy.maxFileCount == 0 && sRotationPolicy.maxTotalBytes == 0)
+		return;
+	// Listing and deleting files can take long, the write thread must not wait for it
+	sFileWorker.Post([sDirectory = std::filesystem::path(sOutFileName).parent_path(), sBaseName = sLogsBasedName, sKeepFile = std::filesystem::path(sOutFileName),
+		maxFileCount = sRotationPolicy.maxFileCount, maxTotalBytes = sRotationPolicy.maxTotalBytes]() {
+		LightLogRotation::ApplyRetention(sDirectory, sBaseName, sKeepFile, maxFileCount, maxTotalBytes);
+		});
 }
 
-void LightLogWrite_Impl::RunWriteThread()
+void LightLogWrite_Impl::OpenLogFileSink(const std::wstring& sFilename, LightLogFileSink* pPreparedSink)
+{
+	// The file being replaced is made durable first when syncing was asked for
+	if (HasDurabilityPolicy())
+		pLogFileSink.Sync();
+	eOpenFileFormat = eOutputFormat;
+	if (pPreparedSink)
+		pLogFileSink.Adopt(*pPreparedSink);
+	else if (!pLogFileSink.Open(std::filesystem::path(sFilename), writeBufferSize.load(std::memory_order_relaxed), eFileSinkMode.load(std::memory_order_relaxed),
+		mmapSegmentSize.load(std::memory_order_relaxed), eStreamCompression.load(std::memory_order_relaxed), streamFrameSize.load(std::memory_order_relaxed)))
+		return;
+	if (eOpenFileFormat != LogOutputFormat::Binary)
+		return;
+
+	auto sNowUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+	sBinaryBuffer.clear();
+	sBinaryEncoder.BeginSegment(sBinaryBuffer, sNowUs);
+	pLogFileSink.Append(sBinaryBuffer, sNowUs);
+}
+
+void LightLogWrite_Impl::ChecksLogRotation(std::chrono::system_clock::time_point sNow)
+{
+	// Both thresholds stay at their maximum unless lasting logs are on
+	if (sNow < sRotationCheckAt && currentFileBytes < rotationCheckBytes)
+		return;
+	if (sNow < sRotationDeadline && currentFileBytes < rotationMaxBytes) {
+		// Close to a boundary: open the file that comes next in the background, then wait for the boundary itself
+		sRotationCheckAt = sRotationDeadline;
+		rotationCheckBytes = rotationMaxBytes;
+		if (sRotationDeadline - sNow <= kPreopenLead)
+			PrepareNextLogFile(PeriodLogFilePath(sRotationDeadline).wstring());
+		else
+			PrepareNextLogFile(LightLogRotation::IndexedPath(sPeriodFileName, rotationIndex + 1).wstring());
+		return;
+	}
+	if (currentFileBytes >= rotationMaxBytes)
+		++rotationIndex;
+	CreateLogsFile(sNow);
+}
+
+void LightLogWrite_Impl::PrepareNextLogFile(const std::wstring& sFileName)
+{
+	{
+		std::lock_guard<std::mutex> sPreparedLock(pPreparedMutex);
+		sPreparingFileName = sFileName;
+	}
+	sFileWorker.Post([this, sFileName, bufferSize = writeBufferSize.load(std::memory_order_relaxed), eMode = eFileSinkMode.load(std::memory_order_relaxed),
+		segmentSize = mmapSegmentSize.load(std::memory_order_relaxed), eCompression = eStreamCompression.load(std::memory_order_relaxed),
+		frameSize = streamFrameSize.load(std::memory_order_relaxed)]() {
+		std::lock_guard<std::mutex> sPreparedLock(pPreparedMutex);
+		// The rotation came first, or another file was requested since
+		if (sPreparingFileName != sFileName)
+			return;
+		sPreparingFileName.clear();
+		DiscardPreparedFile();
+		ChecksDirectory(sFileName);
+		PreparedLogFile sPrepared;
+		sPrepared.sFileName = sFileName;
+		sPrepared.fileBytes = ExistingLogFileBytes(sFileName);
+		sPrepared.pSink.reset(new LightLogFileSink(sSinkCounters));
+		if (sPrepared.pSink->Open(std::filesystem::path(sFileName), bufferSize, eMode, segmentSize, eCompression, frameSize))
+			sPreparedFile = std::move(sPrepared);
+		});
+}
+
+void LightLogWrite_Impl::CompressClosedFile(const std::wstring& sFileName)
+{
+	LogCompression eCompression = sRotationPolicy.eCompression;
+	if (eCompression == LogCompression::None || !LightLogCompression::IsAvailable(eCompression))
+		return;
+	// Written with stream compression
+	if (std::filesystem::path(sFileName).extension() == L".gz")
+		return;
+	if (!pCompressionWorker)
+		pCompressionWorker.reset(new LightLogBackgroundWorker(sRotationPolicy.compressionThreads, true));
+	pCompressionWorker->Post([sFilePath = std::filesystem::path(sFileName), eCompression]() {
+		// Segment 0 is the file itself, further segments only exist in LogFileSinkMode::Mmap
+		std::error_code sError;
+		for (size_t index = 0; ; ++index) {
+			std::filesystem::path sSegmentPath = LightLogMmapSink::SegmentPath(sFilePath, index);
+			if (!std::filesystem::exists(sSegmentPath, sError))
+				break;
+			LightLogCompression::CompressFile(sSegmentPath, eCompression);
+		}
+		});
+}
+
+void LightLogWrite_Impl::DiscardPreparedFile()
+{
+	if (!sPreparedFile.pSink)
+		return;
+	sPreparedFile.pSink.reset();
+	// Created by the preparation and never written, an mmap sink has removed it already
+	std::error_code sError;
+	if (sPreparedFile.fileBytes == 0 && std::filesystem::file_size(sPreparedFile.sFileName, sError) == 0 && !sError)
+		std::filesystem::remove(sPreparedFile.sFileName, sError);
+	sPreparedFile = PreparedLogFile();
+}
+
+void LightLogWrite_Impl::WriteLogRecord(const LightLogWriteInfo& sLogMessageInf)
 {
+	// The record's own capture time, not the time the writer got to it
+	auto sNow = sLogClock.ToTimePoint(sLogMessageInf.enqueueTicks);
+	auto sNowUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(sNow.time_since_epoch()).count());
+	sTimestampCache.Update(sNow);
+	ChecksLogRotation(sNow);
+
+	LightLogTagEntry* pTagEntry = nullptr;
+	if (sLogMessageInf.tagId != kNoLogTagId) {
+		pTagEntry = &sTagRegistry.Get(sLogMessageInf.tagId);
+		// Only the write thread increments, a relaxed read-modify-write never contends
+		pTagEntry->writtenCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bool bFileOpen = pLogFileSink.IsOpen();
+	bool bTextFile = bFileOpen && eOpenFileFormat != LogOutputFormat::Binary;
+	if (bFileOpen && !bUnsyncedWrites) {
+		bUnsyncedWrites = true;
+		sUnsyncedSince = std::chrono::steady_clock::now();
+	}
+	if (bFileOpen && !bTextFile) {
+		std::string_view sTagName = pTagEntry ? std::string_view(pTagEntry->sTagName) : sLogMessageInf.GetTagName();
+		sBinaryBuffer.clear();
+		sBinaryEncoder.EncodeRecord(sBinaryBuffer, sLogMessageInf, sTagName, sNowUs);
+		if (pLogFileSink.StartsNewSegment(sBinaryBuffer.size())) {
+			// The record opens a new mapped segment file or compressed frame, which must decode without the previous one
+			sBinaryBuffer.clear();
+			sBinaryEncoder.BeginSegment(sBinaryBuffer, sNowUs);
+			sBinaryEncoder.EncodeRecord(sBinaryBuffer, sLogMessageInf, sTagName, sNowUs);
+		}
+		pLogFileSink.Append(sBinaryBuffer, sNowUs);
+		currentFileBytes += sBinaryBuffer.size();
+	}
+	// The text line is formatted once, for a text file and every attached sink together
+	if (!bTextFile && !pSinkBatch)
+		return;
+	if (!sLogMessageInf.pLogFormatVal && sLogMessageInf.bodyBytes == 0)
+		return;
+
+	// Tag, message and arguments are UTF-8 already, the line is assembled and written as raw bytes
+	sLineBuffer.clear();
+	if (sLogMessageInf.sequence != 0) {
+		char aDigits[24];
+		sLineBuffer += '#';
+		sLineBuffer.append(aDigits, std::to_chars(aDigits, aDigits + sizeof(aDigits), sLogMessageInf.sequence).ptr);
+		sLineBuffer += ' ';
+	}
+	if (pTagEntry) {
+		sLineBuffer += pTagEntry->sLinePrefix;
+	}
+	else {
+		sLineBuffer += sLogMessageInf.GetTagName();
+		sLineBuffer += "-//>>>";
+	}
+	sLineBuffer += sTimestampCache.GetText();
+	sLineBuffer += " : ";
+	if (sLogMessageInf.pLogFormatVal)
+		RenderLogFormat(sLineBuffer, sLogMessageInf.pLogFormatVal, sLogMessageInf.GetArgs());
+	else
+		sLineBuffer += sLogMessageInf.GetContent();
+	sLineBuffer += '\n';
+	if (bTextFile) {
+		pLogFileSink.Append(sLineBuffer, sNowUs);
+		currentFileBytes += sLineBuffer.size();
+	}
+	if (pSinkBatch)
+		pSinkBatch->AddLine(sLineBuffer);
+}
+
+void LightLogWrite_Impl::RunStagingWriteThread()
+{
+	std::vector<std::shared_ptr<LightLogStagingBuffer>> pLocalBuffers;
+	size_t localGeneration = static_cast<size_t>(-1);
+	LightLogWriteInfo sLogMessageInf;
+
+	auto refreshBuffers = [&]() {
+		if (localGeneration == stagingGeneration.load(std::memory_order_acquire))
+			return;
+		std::lock_guard<std::mutex> sLock(pStagingMutex);
+		pLocalBuffers = pStagingBuffers;
+		localGeneration = stagingGeneration.load(std::memory_order_relaxed);
+	};
+	auto hasPending = [&]() {
+		for (auto& pBuffer : pLocalBuffers)
+			if (!pBuffer->sRingQueue.empty())
+				return true;
+		return false;
+	};
+
 	while (true) {
-		if (bHasLogLasting)
-			if (bLastingTmTags != (GetCurrsTimerTm().tm_hour > 12))
-				CreateLogsFile();
-		LightLogWriteInfo sLogMessageInf;
+		// Read before looking at the rings: records queued before these tickets are found below
+		uint64_t syncTicket = syncRequestCount.load(std::memory_order_acquire);
+		refreshBuffers();
+
+		size_t drained = 0;
+		bool bHasExited = false;
+		{
+			std::lock_guard<std::mutex> sFileLock(pLogFileMutex);
+			BeginSinkBatch();
+			for (auto& pBuffer : pLocalBuffers) {
+				for (size_t i = 0; i < kStagingDrainBurst && pBuffer->sRingQueue.pop(sLogMessageInf); ++i) {
+					WriteLogRecord(sLogMessageInf);
+					sLogMessageInf.ReleaseSpill();
+					++drained;
+				}
+				bHasExited = bHasExited || pBuffer->bProducerExited.load(std::memory_order_acquire);
+			}
+			// Nothing pending anywhere: hand the buffered batch to the kernel before going idle
+			if (drained == 0)
+				pLogFileSink.Flush();
+			SyncLogFile(syncTicket, drained == 0);
+			PublishSinkBatch();
+		}
+
+		if (bHasExited) {
+			// Leftovers of exited threads have been written above, forget their empty rings
+			std::lock_guard<std::mutex> sLock(pStagingMutex);
+			auto removeIt = std::remove_if(pStagingBuffers.begin(), pStagingBuffers.end(), [](const std::shared_ptr<LightLogStagingBuffer>& pBuffer) {
+				return pBuffer->bProducerExited.load(std::memory_order_acquire) && pBuffer->sRingQueue.empty();
+				});
+			if (removeIt != pStagingBuffers.end()) {
+				pStagingBuffers.erase(removeIt, pStagingBuffers.end());
+				++stagingGeneration;
+			}
+		}
+
+		if (drained != 0)
+			continue;
+
+		if (bIsStopLogging) {
+			// A record pushed after its ring was scanned above, CloseLogStream's own included, is only
+			// visible now that the flag is: one last full pass over every registered ring before leaving
+			{
+				std::lock_guard<std::mutex> sLock(pStagingMutex);
+				pLocalBuffers = pStagingBuffers;
+				localGeneration = stagingGeneration.load(std::memory_order_relaxed);
+			}
+			std::lock_guard<std::mutex> sFileLock(pLogFileMutex);
+			BeginSinkBatch();
+			for (auto& pBuffer : pLocalBuffers) {
+				while (pBuffer->sRingQueue.pop(sLogMessageInf)) {
+					WriteLogRecord(sLogMessageInf);
+					sLogMessageInf.ReleaseSpill();
+				}
+			}
+			PublishSinkBatch();
+			break;
+		}
 
+		bStagingWriterParked.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
 		{
 			auto sLock = std::unique_lock<std::mutex>(pLogWriteMutex);
-			pWrittenCondVar.wait(sLock, [this]
-				{ return !pLogWriteQueue.empty() || bIsStopLogging; });
+			pWrittenCondVar.wait_for(sLock, std::chrono::milliseconds(10), [&] {
+				return bIsStopLogging || hasPending() || localGeneration != stagingGeneration.load(std::memory_order_acquire)
+					|| syncRequestCount.load(std::memory_order_relaxed) != completedSyncTicket;
+				});
+		}
+		bStagingWriterParked.store(false, std::memory_order_relaxed);
+	}
+	std::lock_guard<std::mutex> sFileLock(pLogFileMutex);
+	pLogFileSink.Flush();
+	FinishSyncRequests();
+	pLogFileSink.Close();
+	std::cerr << "Log write thread Exit\n";
+}
+
+void LightLogWrite_Impl::RunWriteThread()
+{
+	if (eQueueMode == LogWriteQueueMode::ThreadLocalStaging) {
+		RunStagingWriteThread();
+		return;
+	}
+
+	// Producers get this queue's (empty) storage back on every swap, so neither side reallocates
+	GrowableRingQueue<LightLogWriteInfo> sWriteBatch;
+	// When the sink ends its open compressed frame, read under pLogFileMutex after every batch
+	auto sFrameDeadline = std::chrono::steady_clock::time_point::max();
+
+	while (true) {
+		uint64_t syncTicket;
+		bool bCaughtUp;
+		{
+			auto sLock = std::unique_lock<std::mutex>(pLogWriteMutex);
+			uint32_t intervalMs = syncIntervalMs.load(std::memory_order_relaxed);
+			auto hasWork = [&] {
+				return !pLogWriteQueue.empty() || bIsStopLogging || syncRequestCount.load(std::memory_order_relaxed) != completedSyncTicket
+					|| syncIntervalMs.load(std::memory_order_relaxed) != intervalMs;
+			};
+			auto sWakeAt = sFrameDeadline;
+			if (bUnsyncedWrites && intervalMs != 0)
+				sWakeAt = (std::min)(sWakeAt, sUnsyncedSince + std::chrono::milliseconds(intervalMs));
+			// A wake up without records still flushes below, which ends an overdue frame
+			if (sWakeAt != std::chrono::steady_clock::time_point::max())
+				pWrittenCondVar.wait_until(sLock, sWakeAt, hasWork);
+			else
+				pWrittenCondVar.wait(sLock, hasWork);
 
 			if (bIsStopLogging && pLogWriteQueue.empty())
 				break; 
-			if (!pLogWriteQueue.empty()) {
-				sLogMessageInf = pLogWriteQueue.front();
-				pLogWriteQueue.pop();
-				pWrittenCondVar.notify_one();
+
+			// Tickets are bumped under this lock, so their records are all in the queue by now
+			syncTicket = syncRequestCount.load(std::memory_order_acquire);
+
+			// Take the whole pending queue with one swap; only a batch limit smaller than the backlog
+			// makes us move entries one by one under the lock
+			size_t maxBatch = maxWriteBatchSize.load(std::memory_order_relaxed);
+			if (maxBatch == 0 || pLogWriteQueue.size() <= maxBatch) {
+				pLogWriteQueue.swap(sWriteBatch);
+			}
+			else {
+				for (size_t i = 0; i < maxBatch; ++i) {
+					sWriteBatch.push(std::move(pLogWriteQueue.front()));
+					pLogWriteQueue.pop();
+				}
 			}
+			bCaughtUp = pLogWriteQueue.empty();
 		}
-		if (!sLogMessageInf.sLogContentVal.empty() && pLogFileStream.is_open()) {
-			pLogFileStream << sLogMessageInf.sLogTagNameVal << L"-//>>>" << GetCurrentTimer() << " : " << sLogMessageInf.sLogContentVal << "\n";
+		if (queueFullStrategy == LogQueueOverflowStrategy::Block)
+			pWrittenCondVar.notify_all();
+
+		std::lock_guard<std::mutex> sFileLock(pLogFileMutex);
+		BeginSinkBatch();
+		while (!sWriteBatch.empty()) {
+			WriteLogRecord(sWriteBatch.front());
+			sWriteBatch.front().ReleaseSpill();
+			sWriteBatch.pop();
 		}
+		pLogFileSink.Flush();
+		SyncLogFile(syncTicket, bCaughtUp);
+		sFrameDeadline = pLogFileSink.GetFrameDeadline();
+		PublishSinkBatch();
 	}
-	pLogFileStream.close();
+	std::lock_guard<std::mutex> sFileLock(pLogFileMutex);
+	pLogFileSink.Flush();
+	FinishSyncRequests();
+	pLogFileSink.Close();
 	std::cerr << "Log write thread Exit\n";
 }
 
@@ -198,25 +1013,3 @@ void LightLogWrite_Impl::ChecksDirectory(const std::wstring& sFilename)
 	}
 }
 
-std::wstring LightLogWrite_Impl::GetCurrentTimer() const
-{
-	std::tm sTmPartsInfo = GetCurrsTimerTm();
-	std::wostringstream sWosStrStream;
-	sWosStrStream << std::put_time(&sTmPartsInfo, L"%Y-%m-%d %H:%M:%S");
-	return sWosStrStream.str();
-}
-
-
-std::tm LightLogWrite_Impl::GetCurrsTimerTm() const
-{
-	auto sCurrentTime = std::chrono::system_clock::now();
-	std::time_t sCurrTimerTm = std::chrono::system_clock::to_time_t(sCurrentTime);
-	std::tm sCurrTmDatas;
-#ifdef _WIN32
-	localtime_s(&sCurrTmDatas, &sCurrTimerTm);
-#else
-	localtime_r(&sCurrTmDatas, &sCurrTimerTm);
-#endif
-	return sCurrTmDatas;
-
-}
@@ -0,0 +1,100 @@
+#ifndef INCLUDE_GROWABLERINGQUEUE_H_
+#define INCLUDE_GROWABLERINGQUEUE_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     GrowableRingQueue.h
+ *  @brief    只增长不收缩的环形 FIFO 队列
+ *  @details  替代 std::queue (std::deque)，稳态下 push/pop 不再分配内存
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+	* @brief A FIFO ring buffer that grows on demand and never shrinks
+	* @param T The type of elements stored in the queue, must be default constructible and movable
+	* @details std::deque allocates and frees a block every few elements, which makes every log entry
+	* * an allocator round trip. This queue doubles its storage when full and keeps it afterwards,
+	* * so once it has grown to the working set push() and pop() do not allocate.
+	* * It is not thread safe, callers guard it with their own mutex.
+	*/
+template <typename T>
+class GrowableRingQueue {
+public:
+	bool   empty() const { return _size == 0; }
+	size_t size() const { return _size; }
+	size_t capacity() const { return _buffer.size(); }
+
+	T&       front() { return _buffer[_head]; }
+	const T& front() const { return _buffer[_head]; }
+
+	void push(T&& value)
+	{
+		if (_size == _buffer.size())
+			grow();
+		_buffer[(_head + _size) & (_buffer.size() - 1)] = std::move(value);
+		++_size;
+	}
+
+	void push(const T& value)
+	{
+		T sCopy(value);
+		push(std::move(sCopy));
+	}
+
+	void pop()
+	{
+		_head = (_head + 1) & (_buffer.size() - 1);
+		--_size;
+	}
+
+	void swap(GrowableRingQueue& other) noexcept
+	{
+		_buffer.swap(other._buffer);
+		std::swap(_head, other._head);
+		std::swap(_size, other._size);
+	}
+
+private:
+	void grow()
+	{
+		std::vector<T> sNewBuffer(_buffer.empty() ? kInitialCapacity : _buffer.size() * 2);
+		for (size_t i = 0; i < _size; ++i)
+			sNewBuffer[i] = std::move(_buffer[(_head + i) & (_buffer.size() - 1)]);
+		_buffer.swap(sNewBuffer);
+		_head = 0;
+	}
+
+private:
+	static constexpr size_t kInitialCapacity = 1024;  /*!< Power of two */
+
+	std::vector<T>  _buffer;
+	size_t          _head = 0;
+	size_t          _size = 0;
+};
+
+#endif // !INCLUDE_GROWABLERINGQUEUE_H_
@@ -0,0 +1,91 @@
+#ifndef INCLUDE_LIGHTLOGBACKGROUNDWORKER_H_
+#define INCLUDE_LIGHTLOGBACKGROUNDWORKER_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogBackgroundWorker.h
+ *  @brief    后台文件维护线程：删除过期日志、压缩旧日志等慢操作在这里执行，不占用写线程
+ *  @details  需要时才创建线程（不超过上限），可降为最低调度优先级；析构时执行完剩余任务再退出
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+	* @brief Runs posted jobs on up to maxThreads threads of its own
+	* @details Threads are started by Post() when every running one is busy. With one thread the jobs run
+	* * one after the other, with more they are started in order. Jobs must not throw, an escaping
+	* * exception is swallowed so the worker keeps going. Post() may be called from any thread.
+	*/
+class LightLogBackgroundWorker {
+public:
+	/**
+		* @param maxThreads Upper bound of worker threads, at least one
+		* @param bLowPriority Run the threads at idle priority (SCHED_IDLE on Linux, background mode on
+		* * Windows, background QoS on macOS) so they only get CPU time and I/O nobody else wants
+		*/
+	explicit LightLogBackgroundWorker(size_t maxThreads = 1, bool bLowPriority = false);
+
+	/**
+		* @brief Runs every job still queued, then stops the threads
+		*/
+	~LightLogBackgroundWorker();
+
+	LightLogBackgroundWorker(const LightLogBackgroundWorker&) = delete;
+	LightLogBackgroundWorker& operator=(const LightLogBackgroundWorker&) = delete;
+
+	/**
+		* @brief Queues a job, it starts after every job posted before it
+		*/
+	void Post(std::function<void()> job);
+
+	/**
+		* @brief Returns once every job posted before the call has finished
+		*/
+	void WaitIdle();
+
+private:
+	void Run();
+
+	/**
+		* @brief Lowers the scheduling priority of the calling thread, best effort
+		*/
+	static void LowerThreadPriority();
+
+	const size_t                        maxThreads;          /*!< Thread limit                     */
+	const bool                          bLowPriority;        /*!< Threads run at idle priority     */
+	std::mutex                          pJobMutex;           /*!< Guards the members below         */
+	std::condition_variable             pJobCondVar;         /*!< Signals new jobs and finished ones */
+	std::deque<std::function<void()>>   qJobs;               /*!< Jobs not started yet             */
+	size_t                              runningJobs = 0;     /*!< Threads inside a job             */
+	bool                                bStopping = false;   /*!< Set by the destructor            */
+	std::vector<std::thread>            vWorkerThreads;      /*!< Started by Post as needed        */
+};
+
+#endif // !INCLUDE_LIGHTLOGBACKGROUNDWORKER_H_
@@ -0,0 +1,152 @@
+#ifndef INCLUDE_LIGHTLOGBINARYFORMAT_H_
+#define INCLUDE_LIGHTLOGBINARYFORMAT_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogBinaryFormat.h
+ *  @brief    紧凑的二进制日志文件格式
+ *  @details  标签和格式串在每个文件中只写一次，之后每条记录只包含
+ *            varint 时间差、标签/格式 ID 和参数字节。可用 tools/LightLogDecoder 还原为文本
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "LightLogUtf8.h"
+
+/**
+ * @file LightLogBinaryFormat.h
+ * @details File layout, every integer marked varint is LEB128, svarint is zigzag + LEB128:
+ * @code
+ * segment  := "LLWB" version:u8 baseTimeUs:u64le { entry }
+ * entry    := 0x01 tagId:varint len:varint utf8[len]        (tag definition)
+ *           | 0x02 fmtId:varint len:varint utf8[len]        (format definition)
+ *           | 0x03 dtUs:svarint tagId:varint fmtId:varint len:varint args[len]   (record)
+ *           | 0x04 sequence:varint                          (sequence of the record that follows)
+ * arg      := LogArgType:u8 payload
+ *             Int64:svarint  UInt64:varint  Double:f64le  Bool:u8  WChar:varint
+ *             String:len:varint utf8[len]  Pointer:varint  Char:u8
+ * @endcode
+ * * A new segment starts every time the writer (re)opens a file, so appended files decode fine.
+ * * Ids are only valid inside their segment. Format id 0 is the implicit "{}" format used by
+ * * WriteLogContent, its single String argument is the message.
+ * * dtUs is relative to the previous record, or to baseTimeUs for the first record of a segment.
+ * Sequence entries are only written by loggers with LightLogWrite_Impl::SetSequenceCounter.
+ */
+
+struct LightLogWriteInfo;
+
+namespace LightLogBinary {
+
+	constexpr char     kSegmentMagic[4] = { 'L', 'L', 'W', 'B' };
+	constexpr uint8_t  kFormatVersion = 1;
+	constexpr uint8_t  kEntryTagDef = 0x01;
+	constexpr uint8_t  kEntryFormatDef = 0x02;
+	constexpr uint8_t  kEntryRecord = 0x03;
+	constexpr uint8_t  kEntrySequence = 0x04;
+	constexpr uint32_t kPlainMessageFormatId = 0;
+
+	inline void PutVarint(std::string& sOut, uint64_t value)
+	{
+		while (value >= 0x80) {
+			sOut += static_cast<char>((value & 0x7F) | 0x80);
+			value >>= 7;
+		}
+		sOut += static_cast<char>(value);
+	}
+
+	inline void PutSVarint(std::string& sOut, int64_t value)
+	{
+		PutVarint(sOut, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+	}
+
+	/**
+		* @brief Reads a varint, returns false on truncated input
+		*/
+	inline bool GetVarint(const char*& pIn, const char* pEnd, uint64_t& value)
+	{
+		value = 0;
+		for (int shift = 0; pIn < pEnd && shift < 64; shift += 7) {
+			uint8_t byte = static_cast<uint8_t>(*pIn++);
+			value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	inline bool GetSVarint(const char*& pIn, const char* pEnd, int64_t& value)
+	{
+		uint64_t raw;
+		if (!GetVarint(pIn, pEnd, raw))
+			return false;
+		value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+		return true;
+	}
+
+	/**
+		* @brief Encodes LightLogWriteInfo entries into the binary layout
+		* @details The encoder remembers which tags and formats were already defined in the current
+		* * segment, so the caller must call BeginSegment() every time it opens a file.
+		*/
+	class LightLogBinaryEncoder {
+	public:
+		/**
+			* @brief Starts a new segment: writes the segment header and forgets every id
+			* @param sOut Buffer the bytes are appended to
+			* @param baseTimeUs Wall clock time in microseconds since the epoch
+			*/
+		void BeginSegment(std::string& sOut, uint64_t baseTimeUs);
+
+		/**
+			* @brief Appends one record, preceded by tag/format definitions the first time they are seen
+			* @param sOut Buffer the bytes are appended to
+			* @param sLogMessageInf The entry to encode
+			* @param sTagName The UTF-8 tag name of the entry, resolved by the caller for registered tags
+			* @param timeUs Wall clock time of the entry in microseconds since the epoch
+			*/
+		void EncodeRecord(std::string& sOut, const LightLogWriteInfo& sLogMessageInf, std::string_view sTagName, uint64_t timeUs);
+
+	private:
+		uint32_t GetTagId(std::string& sOut, std::string_view sTagName);
+		uint32_t GetFormatId(std::string& sOut, const wchar_t* pszFormat);
+		void     EncodeArgs(std::string& sOut, std::string_view sArgsBuffer);
+
+	private:
+		std::unordered_map<std::string, uint32_t>     mTagIds;         /*!< Tags defined in this segment    */
+		std::vector<uint32_t>                         vRegisteredTagIds; /*!< LogTagId to segment id + 1    */
+		std::unordered_map<const wchar_t*, uint32_t>  mFormatIds;      /*!< Formats defined in this segment */
+		uint64_t                                      lastTimeUs = 0;  /*!< Time of the previous record     */
+		std::string                                   sArgsScratch;    /*!< Reused argument buffer          */
+		std::string                                   sTextScratch;    /*!< Reused UTF-8 text buffer        */
+		std::string                                   sTagKey;         /*!< Reused tag lookup key           */
+	};
+}
+
+#endif // !INCLUDE_LIGHTLOGBINARYFORMAT_H_
@@ -0,0 +1,137 @@
+#ifndef INCLUDE_LIGHTLOGCLOCK_H_
+#define INCLUDE_LIGHTLOGCLOCK_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogClock.h
+ *  @brief    入队时刻的原始时钟计数，以及写线程把计数换算为墙上时间的校准器
+ *  @details  x86 / x64 上读取 TSC，其它平台退回 steady_clock；生产者只读一次计数，
+ *            换算和校准都在写线程完成
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define LIGHTLOG_HAS_TSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define LIGHTLOG_HAS_TSC 1
+#else
+#define LIGHTLOG_HAS_TSC 0
+#endif
+
+/**
+	* @brief Converts raw ticks taken with ReadTicks() into wall clock time
+	* @details ReadTicks() is what producers call, it is a single rdtsc where available (invariant TSC,
+	* * synchronized across cores on every CPU of the last decade) and steady_clock elsewhere.
+	* * The converter belongs to the write thread: it anchors ticks to system_clock and re-measures
+	* * the tick rate against steady_clock, first at doubling intervals and then once a second of
+	* * ticks, which costs one integer compare per converted record otherwise. Not thread safe.
+	*/
+class LightLogClock {
+public:
+	static constexpr int64_t kCalibrationIntervalNs = 1000000000; /*!< Re-anchor after this much tick time */
+	static constexpr int64_t kInitialCalibrationNs = 1000000;     /*!< First TSC rate measurement window    */
+
+	/**
+		* @brief Reads the raw tick counter, cheap enough for every log call
+		*/
+	static uint64_t ReadTicks()
+	{
+#if LIGHTLOG_HAS_TSC
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+	/**
+		* @brief Anchors the clock, on TSC builds this spins for kInitialCalibrationNs to measure the tick rate
+		*/
+	LightLogClock()
+		: baseTicks(ReadTicks()),
+		baseSteady(std::chrono::steady_clock::now())
+	{
+#if LIGHTLOG_HAS_TSC
+		while (std::chrono::steady_clock::now() - baseSteady < std::chrono::nanoseconds(kInitialCalibrationNs)) {
+		}
+#endif
+		Recalibrate();
+	}
+
+	/**
+		* @brief Converts ticks read by ReadTicks() to nanoseconds since the Unix epoch
+		*/
+	int64_t ToUnixNanos(uint64_t ticks)
+	{
+		if (ticks >= nextCalibrationTicks)
+			Recalibrate();
+		double deltaNs = static_cast<double>(static_cast<int64_t>(ticks - anchorTicks)) * nsPerTick;
+		return anchorUnixNs + static_cast<int64_t>(deltaNs);
+	}
+
+	/**
+		* @brief Same as ToUnixNanos as a system_clock time point
+		*/
+	std::chrono::system_clock::time_point ToTimePoint(uint64_t ticks)
+	{
+		return std::chrono::system_clock::time_point(
+			std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ToUnixNanos(ticks))));
+	}
+
+private:
+	void Recalibrate()
+	{
+		uint64_t nowTicks = ReadTicks();
+		auto sNowSteady = std::chrono::steady_clock::now();
+		auto sNowWall = std::chrono::system_clock::now();
+#if LIGHTLOG_HAS_TSC
+		// Measured over everything since construction, so the rate gets more precise the longer we run
+		auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(sNowSteady - baseSteady).count();
+		if (nowTicks > baseTicks && elapsedNs > 0)
+			nsPerTick = static_cast<double>(elapsedNs) / static_cast<double>(nowTicks - baseTicks);
+		// While the measured window is short the rate is rough, so the next anchor comes early
+		int64_t intervalNs = elapsedNs < kCalibrationIntervalNs ? (elapsedNs > kInitialCalibrationNs ? elapsedNs : kInitialCalibrationNs) : kCalibrationIntervalNs;
+#else
+		(void)sNowSteady;
+		nsPerTick = 1e9 * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den;
+		int64_t intervalNs = kCalibrationIntervalNs;
+#endif
+		anchorTicks = nowTicks;
+		anchorUnixNs = std::chrono::duration_cast<std::chrono::nanoseconds>(sNowWall.time_since_epoch()).count();
+		nextCalibrationTicks = nowTicks + static_cast<uint64_t>(static_cast<double>(intervalNs) / nsPerTick);
+	}
+
+	const uint64_t                          baseTicks;                /*!< Ticks at construction                */
+	const std::chrono::steady_clock::time_point baseSteady;           /*!< steady_clock at construction         */
+	uint64_t                                anchorTicks = 0;          /*!< Ticks of the last anchor             */
+	int64_t                                 anchorUnixNs = 0;         /*!< Wall time of the last anchor         */
+	uint64_t                                nextCalibrationTicks = 0; /*!< Re-anchor once a record passes this  */
+	double                                  nsPerTick = 1.0;          /*!< Measured tick period                 */
+};
+
+#endif // !INCLUDE_LIGHTLOGCLOCK_H_
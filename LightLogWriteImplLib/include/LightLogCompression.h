@@ -0,0 +1,70 @@
+#ifndef INCLUDE_LIGHTLOGCOMPRESSION_H_
+#define INCLUDE_LIGHTLOGCOMPRESSION_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogCompression.h
+ *  @brief    切分后旧日志文件的压缩：gzip 写入临时文件，落盘后原子重命名，再删除原文件
+ *  @details  依赖 zlib，仅在定义 LIGHTLOG_HAVE_ZLIB 并链接 zlib 时可用，否则不压缩
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+
+#include <filesystem>
+
+/**
+	* @brief How rotated lasting log files are compressed, see LogRotationPolicy::eCompression
+	* @param None Files are left as they are.
+	* @param Gzip app_2025_06_21_AM.log becomes app_2025_06_21_AM.log.gz. Needs zlib: build with
+	* * LIGHTLOG_HAVE_ZLIB defined and link zlib, otherwise it behaves like None.
+	*/
+enum class LogCompression {
+	None,  /*!< Keep files uncompressed */
+	Gzip   /*!< .gz through zlib        */
+};
+
+namespace LightLogCompression {
+
+	/**
+		* @brief Checks whether this build can compress with eCompression
+		*/
+	bool IsAvailable(LogCompression eCompression);
+
+	/**
+		* @brief Path the compressed form of sPath gets, sPath for LogCompression::None
+		*/
+	std::filesystem::path CompressedPath(const std::filesystem::path& sPath, LogCompression eCompression);
+
+	/**
+		* @brief Compresses a closed file and deletes it
+		* @details Writes "<compressed path>.tmp", syncs it and renames it over the compressed path, so
+		* * readers and a crash see either no compressed file or a complete one; only then is sPath deleted.
+		* * If the compressed file exists already the new data is appended to it as another gzip member.
+		* * Slow, meant for a background thread.
+		* @return false if nothing was done, sPath is left untouched then
+		*/
+	bool CompressFile(const std::filesystem::path& sPath, LogCompression eCompression);
+}
+
+#endif // !INCLUDE_LIGHTLOGCOMPRESSION_H_
@@ -0,0 +1,167 @@
+#ifndef INCLUDE_LIGHTLOGFDFILE_H_
+#define INCLUDE_LIGHTLOGFDFILE_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogFdFile.h
+ *  @brief    以追加方式打开的日志文件描述符：打开、关闭与 writev 写出，以及写出计数
+ *  @details  只有头文件，LightLogFileSink 与无锁日志的 LightLogBufferedFileSink 共用
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+/**
+	* @brief Counters of a log file sink, see LightLogWrite_Impl::GetSinkStats and LockFreeLogWriteImpl::GetSinkStats
+	*/
+struct LightLogSinkStats {
+	uint64_t  writeCalls = 0;    /*!< write / writev system calls issued     */
+	uint64_t  bytesWritten = 0;  /*!< Bytes accepted by the kernel            */
+	uint64_t  failedWrites = 0;  /*!< Calls that failed, their bytes are lost */
+	uint64_t  filesOpened = 0;   /*!< Files opened, including rotations       */
+	uint64_t  asyncWrites = 0;   /*!< Buffers handed to io_uring              */
+	uint64_t  syncCalls = 0;     /*!< fdatasync / msync(MS_SYNC) calls        */
+};
+
+/**
+	* @brief Live counters behind LightLogSinkStats
+	* @details Shared by a logger's sinks, the write thread updates them and so does the file worker
+	* * while it opens the next file ahead of time.
+	*/
+struct LightLogSinkCounters {
+	std::atomic<uint64_t>  writeCalls{ 0 };    /*!< See LightLogSinkStats */
+	std::atomic<uint64_t>  bytesWritten{ 0 };  /*!< See LightLogSinkStats */
+	std::atomic<uint64_t>  failedWrites{ 0 };  /*!< See LightLogSinkStats */
+	std::atomic<uint64_t>  filesOpened{ 0 };   /*!< See LightLogSinkStats */
+	std::atomic<uint64_t>  asyncWrites{ 0 };   /*!< See LightLogSinkStats */
+	std::atomic<uint64_t>  syncCalls{ 0 };     /*!< See LightLogSinkStats */
+
+	/**
+		* @brief Adds to a counter, uncontended in practice: once per system call, not per record
+		*/
+	static void Add(std::atomic<uint64_t>& counter, uint64_t value)
+	{
+		counter.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	LightLogSinkStats Load() const
+	{
+		LightLogSinkStats sStats;
+		sStats.writeCalls = writeCalls.load(std::memory_order_relaxed);
+		sStats.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+		sStats.failedWrites = failedWrites.load(std::memory_order_relaxed);
+		sStats.filesOpened = filesOpened.load(std::memory_order_relaxed);
+		sStats.asyncWrites = asyncWrites.load(std::memory_order_relaxed);
+		sStats.syncCalls = syncCalls.load(std::memory_order_relaxed);
+		return sStats;
+	}
+};
+
+/**
+	* @brief System calls on a raw log file descriptor, common to the file sinks
+	*/
+struct LightLogFdFile {
+	/**
+		* @brief Opens sPath for appending, creating it if needed
+		* @return The file descriptor, or -1 if the file could not be opened
+		*/
+	static int OpenAppend(const std::filesystem::path& sPath, LightLogSinkCounters& sCounters)
+	{
+#ifdef _WIN32
+		int fileHandle = _wopen(sPath.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+		int fileHandle = ::open(sPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+		if (fileHandle >= 0)
+			LightLogSinkCounters::Add(sCounters.filesOpened, 1);
+		return fileHandle;
+	}
+
+	static void Close(int fileHandle)
+	{
+#ifdef _WIN32
+		_close(fileHandle);
+#else
+		::close(fileHandle);
+#endif
+	}
+
+	/**
+		* @brief Writes pFirst followed by pSecond, retrying partial writes
+		* @details One writev for both parts where available. A failed call is counted and the rest is dropped.
+		*/
+	static void WriteOut(int fileHandle, const char* pFirst, size_t firstSize, const char* pSecond, size_t secondSize,
+		LightLogSinkCounters& sCounters)
+	{
+		while (firstSize + secondSize != 0) {
+#ifdef _WIN32
+			// No writev on Windows, the two parts go out one after the other
+			const char* pPart = firstSize != 0 ? pFirst : pSecond;
+			size_t partSize = firstSize != 0 ? firstSize : secondSize;
+			int written = _write(fileHandle, pPart, static_cast<unsigned int>((std::min)(partSize, static_cast<size_t>(INT32_MAX))));
+#else
+			iovec aParts[2];
+			int partCount = 0;
+			if (firstSize != 0)
+				aParts[partCount++] = { const_cast<char*>(pFirst), firstSize };
+			if (secondSize != 0)
+				aParts[partCount++] = { const_cast<char*>(pSecond), secondSize };
+			ssize_t written = ::writev(fileHandle, aParts, partCount);
+#endif
+			LightLogSinkCounters::Add(sCounters.writeCalls, 1);
+			if (written < 0) {
+				if (errno == EINTR)
+					continue;
+				LightLogSinkCounters::Add(sCounters.failedWrites, 1);
+				return;
+			}
+			LightLogSinkCounters::Add(sCounters.bytesWritten, static_cast<uint64_t>(written));
+
+			size_t done = static_cast<size_t>(written);
+			size_t fromFirst = (std::min)(done, firstSize);
+			pFirst += fromFirst;
+			firstSize -= fromFirst;
+			done -= fromFirst;
+			pSecond += done;
+			secondSize -= done;
+		}
+	}
+};
+
+#endif // !INCLUDE_LIGHTLOGFDFILE_H_
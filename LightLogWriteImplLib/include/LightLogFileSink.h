@@ -0,0 +1,197 @@
+#ifndef INCLUDE_LIGHTLOGFILESINK_H_
+#define INCLUDE_LIGHTLOGFILESINK_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogFileSink.h
+ *  @brief    基于文件描述符的日志输出：写线程把字节追加到自有的大缓冲区，缓冲区满或一批写完时才调用一次 write
+ *  @details  替代 std::ofstream，并统计系统调用次数，便于观察缓冲区大小对系统调用数量的影响
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "LightLogCompression.h"
+#include "LightLogFdFile.h"
+#include "LightLogFrameFormat.h"
+
+/**
+	* @brief How LightLogFileSink hands its buffer to the kernel
+	* @param Write One blocking write / writev per full buffer or batch.
+	* @param IoUring Linux only: the buffer is submitted to an io_uring and the writer goes on formatting
+	* * into the next of LightLogIoUring::kInFlightBuffers buffers. Falls back to Write when io_uring
+	* * cannot be set up.
+	* @param Mmap POSIX only: records are copied into preallocated, memory mapped segment files, see
+	* * LightLogMmapSink. Falls back to Write when the file cannot be mapped.
+	*/
+enum class LogFileSinkMode {
+	Write,    /*!< Blocking write          */
+	IoUring,  /*!< Asynchronous io_uring   */
+	Mmap      /*!< Mapped segment files    */
+};
+
+class LightLogIoUring;
+class LightLogMmapSink;
+class LightLogFrameEncoder;
+
+/**
+	* @brief Append-only log file written through a raw file descriptor
+	* @details Append() copies into an owned buffer and only calls write when the buffer is full, so a
+	* * batch of records costs one system call per buffer. A record larger than the buffer goes out
+	* * together with the pending bytes in a single writev. The file is opened in append mode.
+	* * In LogFileSinkMode::IoUring full buffers are submitted asynchronously instead, see LightLogIoUring,
+	* * and in LogFileSinkMode::Mmap records go straight into mapped segment files, see LightLogMmapSink.
+	* * With frame compression each Append() is one record, records are packed into independently
+	* * compressed frames and only finished frames reach the buffer, see LightLogFrameEncoder.
+	* * Not thread safe, the owner serializes Open, Append, Flush and Close; the counters can be read from any thread.
+	*/
+class LightLogFileSink {
+public:
+	static constexpr size_t kDefaultBufferSize = 1u << 20;  /*!< 1 MiB */
+	static constexpr size_t kMinBufferSize = 4096;          /*!< Smaller requests are rounded up */
+	static constexpr size_t kDefaultSegmentSize = 256u << 20; /*!< 256 MiB per LogFileSinkMode::Mmap segment */
+
+	LightLogFileSink();
+
+	/**
+		* @brief A sink that counts into sSharedCounters instead of its own counters, which must outlive it
+		* @details Sinks sharing counters can hand their files over with Adopt.
+		*/
+	explicit LightLogFileSink(LightLogSinkCounters& sSharedCounters);
+
+	~LightLogFileSink();
+
+	LightLogFileSink(const LightLogFileSink&) = delete;
+	LightLogFileSink& operator=(const LightLogFileSink&) = delete;
+
+	/**
+		* @brief Flushes and closes the current file, then opens sPath for appending
+		* @param sPath The log file, its directory must exist
+		* @param bufferSize Size of the write buffer, the buffer is reallocated only when this changes
+		* @param eMode Requested sink mode, IoUring and Mmap silently become Write where they are unavailable
+		* @param segmentSize Size of each segment file in Mmap mode, unused otherwise
+		* @param eCompression LogCompression::Gzip writes frames (LightLogFrameFormat) through Write or IoUring,
+		* * Mmap is not used then. Becomes None where zlib is unavailable.
+		* @param frameSize Uncompressed bytes per frame
+		* @return false if the file could not be opened, the sink is closed then
+		*/
+	bool Open(const std::filesystem::path& sPath, size_t bufferSize = kDefaultBufferSize, LogFileSinkMode eMode = LogFileSinkMode::Write,
+		size_t segmentSize = kDefaultSegmentSize, LogCompression eCompression = LogCompression::None,
+		size_t frameSize = LightLogFrameFormat::kDefaultFrameSize);
+
+	bool IsOpen() const { return fileHandle >= 0 || pMmapSink != nullptr; }
+
+	/**
+		* @brief Checks whether the open file is written through io_uring
+		*/
+	bool IsIoUringActive() const { return pIoUring != nullptr; }
+
+	/**
+		* @brief Checks whether Append(size bytes) would begin a new segment file or compressed frame
+		* @details Lets the binary format start that file or frame with its own segment header.
+		*/
+	bool StartsNewSegment(size_t size) const;
+
+	/**
+		* @brief Appends bytes to the write buffer, writing the buffer out when they do not fit
+		* @param timeUs Capture time of the record, microseconds since the epoch; indexes compressed frames
+		*/
+	void Append(const char* pData, size_t size, uint64_t timeUs = 0);
+
+	void Append(std::string_view sData, uint64_t timeUs = 0) { Append(sData.data(), sData.size(), timeUs); }
+
+	/**
+		* @brief Writes out the buffered bytes, call it at the end of every batch
+		* @details A compressed frame is ended here once it has been open for LightLogFrameEncoder::kMaxFrameDelay.
+		*/
+	void Flush();
+
+	/**
+		* @brief When Flush() will end the open compressed frame, time_point::max() when there is none
+		* @details The write thread wakes up for it even if no record arrives.
+		*/
+	std::chrono::steady_clock::time_point GetFrameDeadline() const;
+
+	/**
+		* @brief Flushes and waits until everything appended to this file is on disk
+		* @details fdatasync (_commit on Windows), after waiting for the in-flight io_uring writes, or
+		* * msync(MS_SYNC) in Mmap mode. Returns at once if nothing was appended since the last call.
+		* * An open compressed frame is ended first.
+		*/
+	void Sync();
+
+	/**
+		* @brief Flushes and closes the file, nothing happens if none is open
+		* @details A compressed file gets its frame index and trailer here.
+		* @note Does not sync, call Sync() first when the file must be durable.
+		*/
+	void Close();
+
+	/**
+		* @brief Closes the current file and takes over the file sPrepared has open, sPrepared is left closed
+		* @details Only swaps handles and buffers, so a file can be opened on another thread with Open and
+		* * switched to here without a system call. Both sinks must share their counters.
+		*/
+	void Adopt(LightLogFileSink& sPrepared);
+
+	LightLogSinkStats GetStats() const;
+
+private:
+	/**
+		* @brief Hands the pending bytes to the kernel, asynchronously in IoUring mode
+		*/
+	void SubmitBuffer();
+
+	/**
+		* @brief Appends bytes that go to the file as they are: records, or frames when compressing
+		*/
+	void AppendBytes(const char* pData, size_t size);
+
+	/**
+		* @brief Ends the open compressed frame and appends it
+		*/
+	void EndFrame();
+
+	int                       fileHandle = -1;       /*!< File descriptor, -1 when closed  */
+	std::unique_ptr<char[]>   pWriteBuffer;          /*!< Buffer of the Write mode         */
+	char*                     pActiveBuffer = nullptr; /*!< Buffer being filled            */
+	size_t                    bufferCapacity = 0;    /*!< Size of pActiveBuffer            */
+	size_t                    bufferUsed = 0;        /*!< Pending byte count               */
+	bool                      bUnsynced = false;     /*!< Appended to since the last Sync  */
+	std::unique_ptr<LightLogIoUring> pIoUring;       /*!< Set in IoUring mode              */
+	std::unique_ptr<LightLogMmapSink> pMmapSink;     /*!< Set in Mmap mode                 */
+	std::unique_ptr<LightLogFrameEncoder> pFrameEncoder; /*!< Set when compressing         */
+	std::string               sFrameBytes;           /*!< Finished frames to append        */
+	LightLogSinkCounters      sOwnCounters;          /*!< Used unless counters are shared  */
+	LightLogSinkCounters&     sCounters;             /*!< See LightLogSinkStats            */
+};
+
+#endif // !INCLUDE_LIGHTLOGFILESINK_H_
@@ -0,0 +1,251 @@
+#ifndef INCLUDE_LIGHTLOGFORMAT_H_
+#define INCLUDE_LIGHTLOGFORMAT_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogFormat.h
+ *  @brief    延迟格式化：调用线程只拷贝参数字节，写线程再渲染文本
+ *  @details  格式串使用 "{}" 作为占位符，"{{" 和 "}}" 转义花括号
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+	* @brief Builds a compile-time format string for LightLogWrite_Impl::Log
+	* @param s A narrow or wide string literal, e.g. LIGHTLOG_FMT("request {} took {} ms")
+	* @details The literal is wrapped into a unique type, so the number of "{}" placeholders can be
+	* * checked against the number of arguments with a static_assert. The text is always stored wide.
+	*/
+#define LIGHTLOG_FMT(s)                                                           \
+	[] {                                                                          \
+		struct LightLogFormatLiteral : LightLogFormatString {                     \
+			static constexpr const wchar_t* value() { return L"" s; }              \
+		};                                                                        \
+		return LightLogFormatLiteral{};                                           \
+	}()
+
+/**
+	* @brief Tag base of every type produced by LIGHTLOG_FMT
+	*/
+struct LightLogFormatString {};
+
+/**
+	* @brief Type tag stored in front of every captured argument
+	*/
+enum class LogArgType : uint8_t {
+	Int64,    /*!< Any signed integral, stored as int64_t                      */
+	UInt64,   /*!< Any unsigned integral, stored as uint64_t                   */
+	Double,   /*!< float / double / long double, stored as double              */
+	Bool,     /*!< bool, stored as one byte                                    */
+	WChar,    /*!< wchar_t, stored as uint32_t code unit                       */
+	WString,  /*!< Wide text, stored as uint32_t length + wchar_t code units   */
+	String,   /*!< Narrow text in UTF-8, uint32_t length + bytes               */
+	Pointer,  /*!< void pointer, stored as uintptr_t                           */
+	Char      /*!< char / char8_t, stored as one UTF-8 code unit               */
+};
+
+/**
+	* @brief Counts the "{}" placeholders of a format string
+	* @return The number of placeholders, or size_t(-1) if a brace is not matched or escaped
+	*/
+constexpr size_t CountFormatPlaceholders(const wchar_t* pszFormat)
+{
+	size_t count = 0;
+	for (size_t i = 0; pszFormat[i] != L'\0'; ++i) {
+		if (pszFormat[i] == L'{') {
+			if (pszFormat[i + 1] == L'{')
+				++i;
+			else if (pszFormat[i + 1] == L'}') {
+				++count;
+				++i;
+			}
+			else
+				return static_cast<size_t>(-1);
+		}
+		else if (pszFormat[i] == L'}') {
+			if (pszFormat[i + 1] != L'}')
+				return static_cast<size_t>(-1);
+			++i;
+		}
+	}
+	return count;
+}
+
+namespace LightLogFormatDetail {
+
+	template <typename T>
+	using Decay = std::remove_cv_t<std::remove_reference_t<T>>;
+
+	template <typename T>
+	struct IsWideText : std::bool_constant<
+		std::is_same_v<Decay<T>, std::wstring> || std::is_same_v<Decay<T>, std::wstring_view> ||
+		std::is_same_v<std::decay_t<T>, const wchar_t*> || std::is_same_v<std::decay_t<T>, wchar_t*>> {};
+
+	template <typename T>
+	struct IsNarrowText : std::bool_constant<
+		std::is_same_v<Decay<T>, std::string> || std::is_same_v<Decay<T>, std::string_view> ||
+		std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*>> {};
+
+	/**
+		* @brief char and char8_t are printed as characters; signed char and unsigned char stay numbers
+		*/
+	template <typename T>
+	struct IsNarrowChar : std::bool_constant<std::is_same_v<Decay<T>, char>
+#ifdef __cpp_char8_t
+		|| std::is_same_v<Decay<T>, char8_t>
+#endif
+	> {};
+
+	template <typename T>
+	constexpr bool kIsSupported =
+		std::is_arithmetic_v<Decay<T>> || std::is_pointer_v<std::decay_t<T>> ||
+		IsWideText<T>::value || IsNarrowText<T>::value;
+
+	/**
+		* @brief Size in bytes one argument occupies in the captured buffer
+		*/
+	template <typename T>
+	size_t EncodedSize(const T& value)
+	{
+		using D = Decay<T>;
+		if constexpr (IsWideText<T>::value)
+			return 1 + sizeof(uint32_t) + std::wstring_view(value).size() * sizeof(wchar_t);
+		else if constexpr (IsNarrowText<T>::value)
+			return 1 + sizeof(uint32_t) + std::string_view(value).size();
+		else if constexpr (std::is_same_v<D, bool> || IsNarrowChar<T>::value)
+			return 1 + 1;
+		else if constexpr (std::is_same_v<D, wchar_t>)
+			return 1 + sizeof(uint32_t);
+		else if constexpr (std::is_pointer_v<std::decay_t<T>>)
+			return 1 + sizeof(uintptr_t);
+		else
+			return 1 + 8;
+	}
+
+	inline char* PutBytes(char* pOut, const void* pData, size_t len)
+	{
+		std::memcpy(pOut, pData, len);
+		return pOut + len;
+	}
+
+	/**
+		* @brief Copies one argument's raw bytes behind its type tag
+		*/
+	template <typename T>
+	char* EncodeArg(char* pOut, const T& value)
+	{
+		using D = Decay<T>;
+		auto putTag = [&](LogArgType type) { *pOut++ = static_cast<char>(type); };
+		if constexpr (IsWideText<T>::value) {
+			std::wstring_view sView(value);
+			uint32_t len = static_cast<uint32_t>(sView.size());
+			putTag(LogArgType::WString);
+			pOut = PutBytes(pOut, &len, sizeof(len));
+			return PutBytes(pOut, sView.data(), len * sizeof(wchar_t));
+		}
+		else if constexpr (IsNarrowText<T>::value) {
+			std::string_view sView(value);
+			uint32_t len = static_cast<uint32_t>(sView.size());
+			putTag(LogArgType::String);
+			pOut = PutBytes(pOut, &len, sizeof(len));
+			return PutBytes(pOut, sView.data(), len);
+		}
+		else if constexpr (std::is_same_v<D, bool>) {
+			putTag(LogArgType::Bool);
+			*pOut++ = value ? 1 : 0;
+			return pOut;
+		}
+		else if constexpr (IsNarrowChar<T>::value) {
+			putTag(LogArgType::Char);
+			*pOut++ = static_cast<char>(value);
+			return pOut;
+		}
+		else if constexpr (std::is_same_v<D, wchar_t>) {
+			uint32_t ch = static_cast<uint32_t>(value);
+			putTag(LogArgType::WChar);
+			return PutBytes(pOut, &ch, sizeof(ch));
+		}
+		else if constexpr (std::is_pointer_v<std::decay_t<T>>) {
+			uintptr_t address = reinterpret_cast<uintptr_t>(value);
+			putTag(LogArgType::Pointer);
+			return PutBytes(pOut, &address, sizeof(address));
+		}
+		else if constexpr (std::is_floating_point_v<D>) {
+			double number = static_cast<double>(value);
+			putTag(LogArgType::Double);
+			return PutBytes(pOut, &number, sizeof(number));
+		}
+		else if constexpr (std::is_signed_v<D>) {
+			int64_t number = static_cast<int64_t>(value);
+			putTag(LogArgType::Int64);
+			return PutBytes(pOut, &number, sizeof(number));
+		}
+		else {
+			uint64_t number = static_cast<uint64_t>(value);
+			putTag(LogArgType::UInt64);
+			return PutBytes(pOut, &number, sizeof(number));
+		}
+	}
+}
+
+/**
+	* @brief Number of bytes EncodeLogArgs writes for these arguments
+	*/
+template <typename... Args>
+size_t LogArgsSize(const Args&... args)
+{
+	static_assert((LightLogFormatDetail::kIsSupported<Args> && ...),
+		"LightLogWrite_Impl::Log only accepts arithmetic values, pointers and (w)string / (w)string_view / C strings");
+	return (size_t{ 0 } + ... + LightLogFormatDetail::EncodedSize(args));
+}
+
+/**
+	* @brief Captures the raw bytes of every argument
+	* @param pOut Output buffer of at least LogArgsSize(args...) bytes
+	* @details Only arithmetic values, pointers and text are accepted. Text is copied,
+	* * so the caller's strings may go away as soon as this returns.
+	*/
+template <typename... Args>
+void EncodeLogArgs(char* pOut, const Args&... args)
+{
+	((pOut = LightLogFormatDetail::EncodeArg(pOut, args)), ...);
+	(void)pOut;
+}
+
+/**
+	* @brief Renders a format string and the arguments captured by EncodeLogArgs as UTF-8
+	* @param sOutput The rendered text is appended to it, so the write thread can render straight into its line buffer
+	* @param pszFormat The format string, "{}" is replaced by the next argument
+	* @param sArgsBuffer The captured arguments
+	* @details Narrow text arguments are taken to be UTF-8 already and copied as is, wide ones are converted.
+	*/
+void RenderLogFormat(std::string& sOutput, const wchar_t* pszFormat, std::string_view sArgsBuffer);
+
+#endif // !INCLUDE_LIGHTLOGFORMAT_H_
@@ -0,0 +1,156 @@
+#ifndef INCLUDE_LIGHTLOGFRAMEFORMAT_H_
+#define INCLUDE_LIGHTLOGFRAMEFORMAT_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogFrameFormat.h
+ *  @brief    边写边压缩的日志文件格式：记录按固定大小分块，每块压缩为独立的 gzip 成员（帧）
+ *  @details  帧头的 gzip 扩展字段记录帧长度与首条记录时间，关闭文件时追加帧索引和尾部，
+ *            可按时间随机定位；崩溃后没有尾部时逐帧跳读即可恢复。整个文件仍可直接用 zcat 读取。
+ *            依赖 zlib，仅在定义 LIGHTLOG_HAVE_ZLIB 时可用
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+	* @brief On-disk layout of a frame compressed log file (BGZF style, every member is a valid gzip member)
+	* @details Each member starts with the fixed gzip header 1f 8b 08 04 (FEXTRA), mtime 0, xfl 0, os 0xff,
+	* * followed by XLEN and exactly one subfield "L?" with a little-endian payload:
+	* * "LF" frame:   memberSize u32, firstTimeUs u64, then the raw deflate data, CRC32 and ISIZE.
+	* * "LI" index:   up to kIndexEntriesPerMember (fileOffset u64, firstTimeUs u64) pairs, empty payload.
+	* * "LT" trailer: indexOffset u64, sessionStart u64, frameCount u64, empty payload, always kTrailerSize bytes.
+	* * Closing a file appends the index members and the trailer. A file reopened for appending gets
+	* * another session of frames, index and trailer; sessionStart links the trailers back to front.
+	* * Index and trailer members decompress to nothing, so zcat prints exactly the logged bytes.
+	*/
+namespace LightLogFrameFormat {
+	constexpr size_t   kDefaultFrameSize = 64u << 10;        /*!< Uncompressed bytes per frame      */
+	constexpr size_t   kHeaderSize = 16;                     /*!< gzip header, XLEN, subfield id and length */
+	constexpr size_t   kFrameExtraSize = 12;                 /*!< "LF" payload                      */
+	constexpr size_t   kIndexEntrySize = 16;                 /*!< One "LI" entry                    */
+	constexpr size_t   kIndexEntriesPerMember = 4000;        /*!< Keeps XLEN below 65536            */
+	constexpr size_t   kTrailerSize = kHeaderSize + 24 + 2 + 8; /*!< Header, payload, empty deflate, CRC32 and ISIZE */
+	constexpr char     kFrameId = 'F';                       /*!< Second subfield byte of a frame   */
+	constexpr char     kIndexId = 'I';                       /*!< ... of an index member            */
+	constexpr char     kTrailerId = 'T';                     /*!< ... of the trailer                */
+
+	/**
+		* @brief Where a frame starts and the time of its first record
+		*/
+	struct FrameEntry {
+		uint64_t  fileOffset = 0;   /*!< Offset of the frame's gzip member       */
+		uint64_t  firstTimeUs = 0;  /*!< Microseconds since the epoch            */
+	};
+
+	/**
+		* @brief Lists the frames of a file, from the trailers when the file was closed cleanly
+		* @details Sessions without a trailer (the process died) are recovered by hopping from one member
+		* * header to the next; a frame cut short by the crash is left out.
+		* @return false if the file cannot be read or holds no frame member at its start
+		*/
+	bool ReadFrameIndex(const std::filesystem::path& sPath, std::vector<FrameEntry>& vFrames);
+
+	/**
+		* @brief Decompresses a single frame listed by ReadFrameIndex
+		* @param sOut Receives the frame's uncompressed bytes, whole records only
+		* @return false if the frame is damaged or zlib is not available
+		*/
+	bool ReadFrame(const std::filesystem::path& sPath, const FrameEntry& sFrame, std::string& sOut);
+}
+
+/**
+	* @brief Packs appended records into frames and compresses each frame as it fills, see LightLogFrameFormat
+	* @details Owned by LightLogFileSink, which writes whatever bytes the encoder hands back. A record
+	* * never straddles two frames: a record that does not fit ends the frame first, and a record larger
+	* * than a frame gets a frame of its own. Not thread safe.
+	*/
+class LightLogFrameEncoder {
+public:
+	/**
+		* @brief A frame that stays open this long is ended by the next Flush of the sink
+		*/
+	static constexpr std::chrono::milliseconds kMaxFrameDelay{ 1000 };
+
+	/**
+		* @param frameSize Uncompressed bytes per frame
+		* @param fileOffset Size of the file when it was opened, the first frame starts there
+		* @return The encoder, or null when zlib is not available
+		*/
+	static std::unique_ptr<LightLogFrameEncoder> Create(size_t frameSize, uint64_t fileOffset);
+
+	~LightLogFrameEncoder();
+
+	LightLogFrameEncoder(const LightLogFrameEncoder&) = delete;
+	LightLogFrameEncoder& operator=(const LightLogFrameEncoder&) = delete;
+
+	/**
+		* @brief Checks whether a record of size bytes would begin a new frame
+		*/
+	bool StartsNewFrame(size_t size) const { return sFrameBytes.empty() || size > frameSize - sFrameBytes.size(); }
+
+	/**
+		* @brief Adds a record to the open frame, appending any frame it completes to sOut
+		* @param timeUs Capture time of the record, microseconds since the epoch
+		*/
+	void AppendRecord(const char* pData, size_t size, uint64_t timeUs, std::string& sOut);
+
+	/**
+		* @brief Compresses the open frame into sOut, nothing happens if it is empty
+		*/
+	void EndFrame(std::string& sOut);
+
+	/**
+		* @brief When the open frame is due to be ended, time_point::max() when none is open
+		*/
+	std::chrono::steady_clock::time_point GetFrameDeadline() const;
+
+	/**
+		* @brief Ends the open frame and appends the index and the trailer to sOut, the encoder is done then
+		*/
+	void Finish(std::string& sOut);
+
+private:
+	struct DeflateState;
+
+	LightLogFrameEncoder(size_t frameSize, uint64_t fileOffset);
+
+	std::unique_ptr<DeflateState>  pDeflate;            /*!< zlib stream, reset for every frame */
+	const size_t                   frameSize;           /*!< Uncompressed bytes per frame       */
+	const uint64_t                 sessionStart;        /*!< File size at open                  */
+	uint64_t                       fileOffset;          /*!< Where the next member starts       */
+	std::string                    sFrameBytes;         /*!< Records of the open frame          */
+	uint64_t                       frameTimeUs = 0;     /*!< First record of the open frame     */
+	std::chrono::steady_clock::time_point sFrameOpened; /*!< When the open frame got its first record */
+	std::vector<LightLogFrameFormat::FrameEntry> vFrames; /*!< Frames written in this session   */
+};
+
+#endif // !INCLUDE_LIGHTLOGFRAMEFORMAT_H_
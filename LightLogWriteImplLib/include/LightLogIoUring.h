@@ -0,0 +1,135 @@
+#ifndef INCLUDE_LIGHTLOGIOURING_H_
+#define INCLUDE_LIGHTLOGIOURING_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogIoUring.h
+ *  @brief    Linux io_uring 异步写文件：写线程提交缓冲区 N 后继续向缓冲区 N+1 格式化，不再阻塞在 write 上
+ *  @details  直接使用 io_uring_setup / io_uring_enter 系统调用，不依赖 liburing；内核不支持或被禁用时
+ *            Create 返回空指针，LightLogFileSink 退回普通 write
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "LightLogFileSink.h"
+
+/**
+	* @brief A small io_uring with kInFlightBuffers write buffers for one log file
+	* @details Every submitted buffer gets an explicit file offset, reserved in submission order, so
+	* * writes may complete in any order without reordering the file. For that reason the file must
+	* * not be in O_APPEND mode and must not be written by anybody else while the ring is alive.
+	* * Short writes are finished synchronously with pwrite when their completion is reaped.
+	* * Owned by the write thread, not thread safe.
+	*/
+class LightLogIoUring {
+public:
+	static constexpr size_t kInFlightBuffers = 4;  /*!< Buffers the writer rotates through */
+
+	/**
+		* @brief Sets up a ring for fileHandle, positioned at the current end of the file
+		* @param fileHandle An open file descriptor, O_APPEND is cleared on success
+		* @param bufferSize Size of each of the kInFlightBuffers buffers
+		* @param sCounters Counters of the owning sink, updated for every system call
+		* @return The ring, or null when io_uring is not available (not Linux, old kernel, seccomp...)
+		*/
+	static std::unique_ptr<LightLogIoUring> Create(int fileHandle, size_t bufferSize, LightLogSinkCounters& sCounters);
+
+	/**
+		* @brief Waits for every in-flight write and releases the ring, the file stays open
+		*/
+	~LightLogIoUring();
+
+	LightLogIoUring(const LightLogIoUring&) = delete;
+	LightLogIoUring& operator=(const LightLogIoUring&) = delete;
+
+	/**
+		* @brief Returns the next buffer to format into, waiting only if its last write is still in flight
+		*/
+	char* AcquireBuffer();
+
+	/**
+		* @brief Queues size bytes of a buffer returned by AcquireBuffer at the next file offset, does not wait
+		*/
+	void Submit(char* pBuffer, size_t size);
+
+	/**
+		* @brief Writes bytes that are not in a ring buffer synchronously at the next file offset
+		*/
+	void WriteNow(const char* pData, size_t size);
+
+	/**
+		* @brief Waits until every submitted write has completed
+		*/
+	void WaitAll();
+
+private:
+	LightLogIoUring(int fileHandle, size_t bufferSize, LightLogSinkCounters& sCounters);
+
+	bool Setup();
+
+	/**
+		* @brief Handles every available completion, waits for at least one if bWait is set
+		*/
+	void Reap(bool bWait);
+
+	/**
+		* @brief pwrite loop used for short async writes and WriteNow
+		*/
+	void WriteAt(const char* pData, size_t size, uint64_t offset);
+
+	struct InFlightBuffer {
+		std::unique_ptr<char[]>  pBytes;              /*!< Buffer memory                  */
+		uint64_t                 fileOffset = 0;      /*!< Where the pending write goes   */
+		size_t                   pendingBytes = 0;    /*!< Bytes of the pending write     */
+		bool                     bInFlight = false;   /*!< Submitted and not yet reaped   */
+		alignas(8) unsigned char aIoVec[16];          /*!< struct iovec of the write      */
+	};
+
+	const int                fileHandle;                       /*!< The log file                   */
+	const size_t             bufferSize;                       /*!< Size of every buffer           */
+	LightLogSinkCounters&    sCounters;                        /*!< Counters of the owning sink    */
+	InFlightBuffer           aBuffers[kInFlightBuffers];       /*!< Rotating write buffers         */
+	size_t                   nextBuffer = 0;                   /*!< Index AcquireBuffer hands out  */
+	size_t                   inFlightCount = 0;                /*!< Submitted, not yet reaped      */
+	uint64_t                 nextFileOffset = 0;               /*!< Offset of the next write       */
+	int                      ringHandle = -1;                  /*!< io_uring file descriptor       */
+	void*                    pSqRing = nullptr;                /*!< Mapped submission ring         */
+	size_t                   sqRingBytes = 0;                  /*!< Size of the pSqRing mapping    */
+	void*                    pCqRing = nullptr;                /*!< Mapped completion ring, may alias pSqRing */
+	size_t                   cqRingBytes = 0;                  /*!< Size of the pCqRing mapping    */
+	void*                    pSqEntries = nullptr;             /*!< Mapped submission entries      */
+	size_t                   sqEntriesBytes = 0;               /*!< Size of the pSqEntries mapping */
+	unsigned*                pSqTail = nullptr;                /*!< Kernel shared SQ tail          */
+	unsigned*                pSqArray = nullptr;               /*!< Kernel shared SQ index array   */
+	unsigned                 sqMask = 0;                       /*!< SQ ring mask                   */
+	unsigned*                pCqHead = nullptr;                /*!< Kernel shared CQ head          */
+	unsigned*                pCqTail = nullptr;                /*!< Kernel shared CQ tail          */
+	unsigned                 cqMask = 0;                       /*!< CQ ring mask                   */
+	void*                    pCqEntries = nullptr;             /*!< First io_uring_cqe             */
+};
+
+#endif // !INCLUDE_LIGHTLOGIOURING_H_
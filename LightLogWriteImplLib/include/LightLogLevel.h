@@ -0,0 +1,110 @@
+#ifndef INCLUDE_LIGHTLOGLEVEL_H_
+#define INCLUDE_LIGHTLOGLEVEL_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogLevel.h
+ *  @brief    日志级别：编译期裁剪 + 运行期一次 relaxed 原子读取的过滤
+ *  @details  低于 LIGHTLOG_MIN_LEVEL 的语句在编译期被移除；其余语句在求值任何参数之前
+ *            先与运行期阈值比较，被过滤时不会构造字符串，也不会入队
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <cstdint>
+
+/**
+	* @brief Severity of a log statement, ordered from the most verbose to the most severe
+	*/
+enum class LogLevel : uint8_t {
+	Trace = 0,  /*!< Very detailed tracing           */
+	Debug = 1,  /*!< Debugging output                */
+	Info  = 2,  /*!< Normal operation                */
+	Warn  = 3,  /*!< Something unexpected happened   */
+	Error = 4,  /*!< An operation failed             */
+	Fatal = 5,  /*!< The process cannot go on        */
+	Off   = 6   /*!< As a threshold: disables logging */
+};
+
+/**
+	* @brief Build time threshold, statements below it are removed by the compiler
+	* @details Define it to the numeric value of a LogLevel before including this header or on the
+	* * command line, e.g. -DLIGHTLOG_MIN_LEVEL=2 keeps Info and above. Defaults to 0 (keep everything).
+	*/
+#ifndef LIGHTLOG_MIN_LEVEL
+#define LIGHTLOG_MIN_LEVEL 0
+#endif
+
+constexpr int kLogMinCompiledLevel = LIGHTLOG_MIN_LEVEL;
+
+/**
+	* @brief Checks a level against LIGHTLOG_MIN_LEVEL at compile time
+	*/
+constexpr bool IsLogLevelCompiledIn(LogLevel eLevel)
+{
+	return static_cast<int>(eLevel) >= kLogMinCompiledLevel;
+}
+
+/**
+	* @brief Writes a message only if its level passes both thresholds
+	* @param logger A logger object with IsLevelEnabled(), WriteLogContent(), IsSyncLevel() and Flush()
+	* @param level A constant LogLevel, e.g. LogLevel::Debug
+	* @param tag Anything WriteLogContent accepts as a tag
+	* @param message Anything WriteLogContent accepts as a message
+	* @details Below LIGHTLOG_MIN_LEVEL the statement compiles to nothing. Otherwise the runtime threshold is
+	* * checked with one relaxed atomic load before tag and message are evaluated, so a filtered
+	* * statement never builds its strings. A written statement at or above the logger's sync level
+	* * (LogDurabilityPolicy::eSyncLevel) also requests a sync with Flush().
+	* @code
+	* LIGHTLOG_WRITE(logger, LogLevel::Debug, "NET", "received " + std::to_string(bytes) + " bytes");
+	* @endcode
+	*/
+#define LIGHTLOG_WRITE(logger, level, tag, message)                               \
+	do {                                                                          \
+		if constexpr (IsLogLevelCompiledIn(level)) {                              \
+			if ((logger).IsLevelEnabled(level)) {                                 \
+				(logger).WriteLogContent(tag, message);                           \
+				if ((logger).IsSyncLevel(level))                                  \
+					(logger).Flush();                                             \
+			}                                                                     \
+		}                                                                         \
+	} while (0)
+
+/**
+	* @brief Same as LIGHTLOG_WRITE for the deferred formatting Log() API
+	* @code
+	* LIGHTLOG_LOG(logger, LogLevel::Info, "NET", LIGHTLOG_FMT("received {} bytes"), bytes);
+	* @endcode
+	*/
+#define LIGHTLOG_LOG(logger, level, tag, ...)                                     \
+	do {                                                                          \
+		if constexpr (IsLogLevelCompiledIn(level)) {                              \
+			if ((logger).IsLevelEnabled(level)) {                                 \
+				(logger).Log(tag, __VA_ARGS__);                                   \
+				if ((logger).IsSyncLevel(level))                                  \
+					(logger).Flush();                                             \
+			}                                                                     \
+		}                                                                         \
+	} while (0)
+
+#endif // !INCLUDE_LIGHTLOGLEVEL_H_
@@ -0,0 +1,135 @@
+#ifndef INCLUDE_LIGHTLOGMMAPSINK_H_
+#define INCLUDE_LIGHTLOGMMAPSINK_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogMmapSink.h
+ *  @brief    预分配并映射到内存的日志分段文件：写线程直接 memcpy 到映射区，稳定状态下没有写系统调用
+ *  @details  分段写满时切换到提前建好的下一个分段（xxx.1.log、xxx.2.log ...），回写交给内核；
+ *            关闭分段时按实际长度截断文件。仅 POSIX 平台，其它平台 Create 返回空指针
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "LightLogFileSink.h"
+
+/**
+	* @brief Log output split into preallocated, memory mapped segment files of a fixed size
+	* @details The first segment is the requested path, the next ones insert an index before the
+	* * extension (app_2025_06_21_AM.log, app_2025_06_21_AM.1.log, ...). Each segment is fallocated to
+	* * its full size and mapped, Append() is a memcpy and writeback is left to the kernel.
+	* * Once the active segment is half full the next one is created and mapped ahead of time, so the
+	* * switch itself only swaps two mappings. A record that does not fit in the rest of a segment
+	* * starts the next one; only records larger than a whole segment are split.
+	* * Closing a segment trims the file to the bytes actually written, until then readers see the
+	* * preallocated zeros after the data, and so does a file left behind by a crash. Segments that
+	* * already hold segmentSize bytes are skipped when opening. Owned by the write thread, not thread safe.
+	*/
+class LightLogMmapSink {
+public:
+	static constexpr size_t kMinSegmentSize = 1u << 20;  /*!< Smaller segment sizes are rounded up */
+
+	/**
+		* @brief Maps the first segment of sPath that is not full yet
+		* @param sPath The log file, its directory must exist
+		* @param segmentSize Size of each segment file, rounded up to whole pages
+		* @param sCounters Counters of the owning sink, filesOpened counts every mapped segment
+		* @return The sink, or null when the file cannot be mapped or the platform has no mmap
+		*/
+	static std::unique_ptr<LightLogMmapSink> Create(const std::filesystem::path& sPath, size_t segmentSize, LightLogSinkCounters& sCounters);
+
+	/**
+		* @brief Path of segment number index of sBasePath, 0 is sBasePath itself
+		*/
+	static std::filesystem::path SegmentPath(const std::filesystem::path& sBasePath, size_t index);
+
+	/**
+		* @brief Trims and closes both segments, a segment file that is still empty is removed
+		*/
+	~LightLogMmapSink();
+
+	LightLogMmapSink(const LightLogMmapSink&) = delete;
+	LightLogMmapSink& operator=(const LightLogMmapSink&) = delete;
+
+	/**
+		* @brief Copies bytes into the active segment, moving to the next segment when they do not fit
+		*/
+	void Append(const char* pData, size_t size);
+
+	/**
+		* @brief Checks whether Append(size bytes) would start the next segment file
+		*/
+	bool StartsNewSegment(size_t size) const;
+
+	/**
+		* @brief Waits until everything appended so far is on disk
+		* @details msync(MS_SYNC) of the active segment's new bytes, plus fdatasync of every segment that
+		* * was switched away from since the last Sync.
+		*/
+	void Sync();
+
+private:
+	struct Segment {
+		std::filesystem::path  sPath;                /*!< Segment file                         */
+		int                    fileHandle = -1;      /*!< Open while mapped                    */
+		char*                  pMapping = nullptr;   /*!< Mapped window, null when unused      */
+		uint64_t               mappingOffset = 0;    /*!< File offset of pMapping, page aligned */
+		size_t                 mappingSize = 0;      /*!< Bytes mapped up to the segment end   */
+		size_t                 used = 0;             /*!< Bytes of the window holding data     */
+		size_t                 syncedUsed = 0;       /*!< used at the last Sync                */
+	};
+
+	LightLogMmapSink(const std::filesystem::path& sPath, size_t segmentSize, LightLogSinkCounters& sCounters);
+
+	/**
+		* @brief Opens, preallocates and maps the next segment that is not full into sSegment
+		*/
+	bool MapNextSegment(Segment& sSegment);
+
+	/**
+		* @brief Unmaps sSegment, trims its file to the written bytes and closes it
+		*/
+	void ReleaseSegment(Segment& sSegment);
+
+	/**
+		* @brief Makes the prepared segment the active one, mapping a new one if there is none
+		*/
+	bool AdvanceSegment();
+
+	const std::filesystem::path  sBasePath;          /*!< Path of segment 0                    */
+	const size_t                 segmentSize;        /*!< Size of every segment file           */
+	LightLogSinkCounters&        sCounters;          /*!< Counters of the owning sink          */
+	Segment                      sActive;            /*!< Segment being written                */
+	Segment                      sPrepared;          /*!< Next segment, mapped ahead of time   */
+	bool                         bPrepareFailed = false; /*!< Do not retry until the next switch */
+	std::vector<std::filesystem::path> vUnsyncedSegments; /*!< Released with bytes Sync has not covered */
+	size_t                       nextIndex = 0;      /*!< Index of the next segment to map     */
+};
+
+#endif // !INCLUDE_LIGHTLOGMMAPSINK_H_
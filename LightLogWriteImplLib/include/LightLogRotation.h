@@ -0,0 +1,107 @@
+#ifndef INCLUDE_LIGHTLOGROTATION_H_
+#define INCLUDE_LIGHTLOGROTATION_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogRotation.h
+ *  @brief    持久化日志的切分与保留策略：按小时 / 半天 / 天和文件大小切分，按文件数或总字节数删除旧文件
+ *  @details  切分时刻提前算好，写线程每条记录只需比较一次时间；旧文件的删除在后台线程完成
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "LightLogCompression.h"
+
+/**
+	* @brief Time based rotation of lasting log files, local time
+	* @param HalfDay BaseName_YYYY_MM_DD_AM.log and BaseName_YYYY_MM_DD_PM.log, new files at 00:00 and 12:00.
+	* @param Hourly BaseName_YYYY_MM_DD_HH.log, a new file every hour.
+	* @param Daily BaseName_YYYY_MM_DD.log, a new file at 00:00.
+	* @param Never BaseName.log, only LogRotationPolicy::maxFileBytes starts new files.
+	*/
+enum class LogRotationPeriod {
+	HalfDay,  /*!< Twice a day (default) */
+	Hourly,   /*!< Every hour            */
+	Daily,    /*!< Every day             */
+	Never     /*!< No time based rotation */
+};
+
+/**
+	* @brief How lasting log files are rotated and how many of them are kept
+	* @details A file that reaches maxFileBytes continues in BaseName_<period>-1.log, -2.log and so on.
+	* * After every rotation the oldest files of this base name (by modification time) are deleted on a
+	* * background thread until both retention limits hold, the file being written is never deleted.
+	* * Binary files use the ".llb" extension instead of ".log".
+	* * With eCompression set, every file that rotation closes is compressed on up to compressionThreads
+	* * idle priority threads; compressed files count towards the retention limits like the others.
+	*/
+struct LogRotationPolicy {
+	LogRotationPeriod  ePeriod = LogRotationPeriod::HalfDay;  /*!< Time based rotation              */
+	uint64_t           maxFileBytes = 0;                      /*!< Size based rotation, 0 = off     */
+	size_t             maxFileCount = 0;                      /*!< Files kept, 0 = no limit         */
+	uint64_t           maxTotalBytes = 0;                     /*!< Bytes kept, 0 = no limit         */
+	LogCompression     eCompression = LogCompression::None;   /*!< Compression of closed files      */
+	size_t             compressionThreads = 1;                /*!< Compression thread limit         */
+};
+
+namespace LightLogRotation {
+
+	/**
+		* @brief The first local period boundary after sNow, time_point::max() for LogRotationPeriod::Never
+		*/
+	std::chrono::system_clock::time_point NextDeadline(LogRotationPeriod ePeriod, std::chrono::system_clock::time_point sNow);
+
+	/**
+		* @brief The part of the file name that names the period sNow is in, e.g. L"_2025_06_21_AM"
+		*/
+	std::wstring PeriodSuffix(LogRotationPeriod ePeriod, std::chrono::system_clock::time_point sNow);
+
+	/**
+		* @brief sPath for index 0, otherwise the index inserted before the extension: app.log -> app-3.log,
+		* * app.log.gz -> app-3.log.gz
+		*/
+	std::filesystem::path IndexedPath(const std::filesystem::path& sPath, size_t index);
+
+	/**
+		* @brief Checks whether sFileName is a log file of sBaseName as written by the lasting logs
+		*/
+	bool IsLastingLogFile(const std::wstring& sFileName, const std::wstring& sBaseName);
+
+	/**
+		* @brief Deletes the oldest log files of sBaseName in sDirectory until the limits hold
+		* @param sKeepFile The file being written, never deleted
+		* @param maxFileCount Files kept including sKeepFile, 0 = no limit
+		* @param maxTotalBytes Bytes kept including sKeepFile, 0 = no limit
+		* @details Slow (lists the directory), meant for a background thread. Errors are ignored.
+		*/
+	void ApplyRetention(const std::filesystem::path& sDirectory, const std::wstring& sBaseName, const std::filesystem::path& sKeepFile,
+		size_t maxFileCount, uint64_t maxTotalBytes);
+}
+
+#endif // !INCLUDE_LIGHTLOGROTATION_H_
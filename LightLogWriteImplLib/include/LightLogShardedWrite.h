@@ -0,0 +1,130 @@
+#ifndef INCLUDE_LIGHTLOGSHARDEDWRITE_H_
+#define INCLUDE_LIGHTLOGSHARDEDWRITE_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogShardedWrite.h
+ *  @brief    分片写日志：K 个独立的队列 / 写线程 / 文件，按线程或标签把记录分到各分片
+ *  @details  每条记录入队时取一个全局序号，LightLogMerge 工具按序号把各分片文件合并成一个有序文件
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "LightLogWriteImpl.h"
+
+/**
+	* @brief How LightLogShardedWrite picks the shard of a record
+	* @param Thread Threads are dealt out to the shards round-robin the first time they log, a thread
+	* * always uses the same shard, so its records stay in order within one file.
+	* @param Tag The hash of the tag picks the shard, every record of a tag ends up in the same file.
+	*/
+enum class LogShardKey {
+	Thread,  /*!< By producer thread (default) */
+	Tag      /*!< By tag name                  */
+};
+
+/**
+	* @brief K independent loggers behind one front end, each with its own queue, write thread and file
+	* @details A single write thread formats and writes on one core, the shards let that work spread over K.
+	* * Every shard is a full LightLogWrite_Impl, configure them through GetShard(). All shards share one
+	* * sequence counter (LightLogWrite_Impl::SetSequenceCounter), and tools/LightLogMerge.cpp rebuilds a
+	* * single ordered file from the shard files. Shard i of app.log writes app_shard<i>.log.
+	*/
+class LightLogShardedWrite {
+public:
+	/**
+		* @param shardCount Number of shards, at least one
+		* @param eShardKey How records are spread over the shards
+		* @details The other parameters are passed to every shard, see LightLogWrite_Impl.
+		*/
+	explicit LightLogShardedWrite(size_t shardCount, LogShardKey eShardKey = LogShardKey::Thread, size_t maxQueueSize = 500000,
+		LogQueueOverflowStrategy strategy = LogQueueOverflowStrategy::Block, size_t reportInterval = 100,
+		LogWriteQueueMode queueMode = LogWriteQueueMode::SharedQueue);
+
+	LightLogShardedWrite(const LightLogShardedWrite&) = delete;
+	LightLogShardedWrite& operator=(const LightLogShardedWrite&) = delete;
+
+	size_t GetShardCount() const { return vShards.size(); }
+
+	LightLogWrite_Impl& GetShard(size_t index) { return *vShards[index]; }
+
+	/**
+		* @brief The file of shard index: app.log -> app_shard2.log
+		*/
+	static std::filesystem::path ShardPath(const std::filesystem::path& sPath, size_t index);
+
+	/**
+		* @brief Opens ShardPath(sFilename, i) in every shard
+		*/
+	void SetLogsFileName(const std::wstring& sFilename);
+
+	/**
+		* @brief Lasting logs with the base name sBaseName_shard<i> in every shard, e.g. app_shard0_2025_06_21_AM.log
+		*/
+	void SetLastingsLogs(const std::wstring& sFilePath, const std::wstring& sBaseName);
+
+	/**
+		* @brief The shard a record of this tag goes to from the calling thread
+		*/
+	LightLogWrite_Impl& Route(std::string_view sTypeVal);
+
+	void WriteLogContent(std::string_view sTypeVal, std::string_view sMessage)
+	{
+		Route(sTypeVal).WriteLogContent(sTypeVal, sMessage);
+	}
+
+	/**
+		* @brief See LightLogWrite_Impl::Log
+		*/
+	template <typename FormatT, typename... Args>
+	void Log(std::string_view sTypeVal, FormatT fmt, const Args&... args)
+	{
+		Route(sTypeVal).Log(sTypeVal, fmt, args...);
+	}
+
+	/**
+		* @brief Asks every shard to sync, does not wait
+		*/
+	void Flush();
+
+	/**
+		* @brief Returns once every record queued before the call is on disk, in all shards
+		*/
+	void FlushAndWait();
+
+private:
+	const LogShardKey                                 eShardKey;        /*!< Shard selection         */
+	std::atomic<uint64_t>                             sequenceCounter;  /*!< Shared by the shards, outlives them */
+	std::vector<std::unique_ptr<LightLogWrite_Impl>>  vShards;          /*!< The loggers             */
+};
+
+#endif // !INCLUDE_LIGHTLOGSHARDEDWRITE_H_
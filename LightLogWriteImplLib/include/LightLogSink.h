@@ -0,0 +1,184 @@
+#ifndef INCLUDE_LIGHTLOGSINK_H_
+#define INCLUDE_LIGHTLOGSINK_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogSink.h
+ *  @brief    附加日志输出（标准错误、内存环形缓冲区等）：每个输出有自己的有界队列和线程
+ *  @details  写线程把一批记录格式化一次，以引用计数共享给所有输出；慢的输出只按自己的溢出策略丢弃或阻塞
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class LogQueueOverflowStrategy;
+
+/**
+	* @brief Text lines of one write batch, formatted once by the write thread and shared by every attached sink
+	* @details Immutable once posted, the channels hold it by shared_ptr and the last one to finish frees it.
+	*/
+struct LightLogSinkBatch {
+	std::string           sText;         /*!< The lines back to back, each ends with '\n' */
+	std::vector<uint32_t> vLineEnds;     /*!< End offset of every line in sText           */
+
+	size_t LineCount() const { return vLineEnds.size(); }
+
+	std::string_view Line(size_t index) const
+	{
+		size_t lineBegin = index == 0 ? 0 : vLineEnds[index - 1];
+		return std::string_view(sText.data() + lineBegin, vLineEnds[index] - lineBegin);
+	}
+
+	void AddLine(std::string_view sLine)
+	{
+		sText += sLine;
+		vLineEnds.push_back(static_cast<uint32_t>(sText.size()));
+	}
+
+	void Clear()
+	{
+		sText.clear();
+		vLineEnds.clear();
+	}
+};
+
+/**
+	* @brief An output attached with LightLogWrite_Impl::AddLogSink, next to the log file
+	* @details Write is only ever called on the sink's own channel thread, one batch after the other.
+	* * Sinks get text lines whatever the output format of the log file is.
+	*/
+class LightLogSink {
+public:
+	virtual ~LightLogSink() = default;
+
+	/**
+		* @brief Outputs the lines of a batch, may block, only this sink's channel waits for it
+		*/
+	virtual void Write(const LightLogSinkBatch& sBatch) = 0;
+};
+
+/**
+	* @brief Writes the lines to a C stream, stderr by default, one fwrite and fflush per batch
+	*/
+class LightLogStreamSink : public LightLogSink {
+public:
+	explicit LightLogStreamSink(std::FILE* pStream = stderr) : pStream(pStream) {}
+
+	void Write(const LightLogSinkBatch& sBatch) override;
+
+private:
+	std::FILE*  pStream;  /*!< Not owned */
+};
+
+/**
+	* @brief Keeps the most recent lines in memory for diagnostics, older ones are overwritten
+	*/
+class LightLogMemorySink : public LightLogSink {
+public:
+	/**
+		* @param capacity Lines kept, at least one
+		*/
+	explicit LightLogMemorySink(size_t capacity);
+
+	void Write(const LightLogSinkBatch& sBatch) override;
+
+	/**
+		* @brief Copies the kept lines, oldest first, without their '\n'
+		* @details May be called from any thread.
+		*/
+	std::vector<std::string> GetLines() const;
+
+private:
+	mutable std::mutex        pLinesMutex;     /*!< Guards the members below        */
+	std::vector<std::string>  vLines;          /*!< Ring of lines, slots keep their capacity */
+	size_t                    nextLine = 0;    /*!< Slot the next line goes to      */
+	size_t                    lineCount = 0;   /*!< Slots in use                    */
+};
+
+/**
+	* @brief Counters of an attached sink, see LightLogWrite_Impl::GetLogSinkStats
+	*/
+struct LightLogSinkChannelStats {
+	uint64_t  writtenLines = 0;   /*!< Lines handed to the sink            */
+	uint64_t  droppedLines = 0;   /*!< Lines dropped because it fell behind */
+	size_t    queuedLines = 0;    /*!< Lines waiting right now             */
+};
+
+/**
+	* @brief Bounded queue of batches in front of one sink, drained by a thread of its own
+	* @details Post is called by the logger's write thread. When more than capacity lines are queued,
+	* * LogQueueOverflowStrategy::DropOldest drops whole batches from the front and Block makes Post wait,
+	* * which stalls the write thread; a batch larger than the capacity is still queued on its own.
+	*/
+class LightLogSinkChannel {
+public:
+	LightLogSinkChannel(std::shared_ptr<LightLogSink> pSink, size_t capacity, LogQueueOverflowStrategy eStrategy);
+
+	/**
+		* @brief Stops the channel, see Stop
+		*/
+	~LightLogSinkChannel();
+
+	LightLogSinkChannel(const LightLogSinkChannel&) = delete;
+	LightLogSinkChannel& operator=(const LightLogSinkChannel&) = delete;
+
+	/**
+		* @brief Queues a batch for the sink, ignored once the channel is stopped
+		*/
+	void Post(std::shared_ptr<const LightLogSinkBatch> pBatch);
+
+	/**
+		* @brief Lets the sink write what is queued, then ends the thread
+		*/
+	void Stop();
+
+	LightLogSinkChannelStats GetStats() const;
+
+private:
+	void Run();
+
+	const std::shared_ptr<LightLogSink>  pSink;          /*!< The output                      */
+	const size_t                         capacity;       /*!< Queued lines before overflowing */
+	const bool                           bBlockWhenFull; /*!< LogQueueOverflowStrategy::Block */
+	mutable std::mutex                   pQueueMutex;    /*!< Guards the members below        */
+	std::condition_variable              pQueueCondVar;  /*!< Signals batches and free space  */
+	std::deque<std::shared_ptr<const LightLogSinkBatch>> qBatches; /*!< Batches not written yet */
+	size_t                               queuedLines = 0;  /*!< Lines in qBatches             */
+	uint64_t                             writtenLines = 0; /*!< See LightLogSinkChannelStats  */
+	uint64_t                             droppedLines = 0; /*!< See LightLogSinkChannelStats  */
+	bool                                 bStopping = false; /*!< Set by Stop                  */
+	std::thread                          sSinkThread;    /*!< Calls pSink->Write              */
+};
+
+#endif // !INCLUDE_LIGHTLOGSINK_H_
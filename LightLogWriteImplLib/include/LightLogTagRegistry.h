@@ -0,0 +1,108 @@
+#ifndef INCLUDE_LIGHTLOGTAGREGISTRY_H_
+#define INCLUDE_LIGHTLOGTAGREGISTRY_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogTagRegistry.h
+ *  @brief    日志标签注册表：标签名只保存一次，日志记录里只携带整数 ID
+ *  @details  每个标签预先编码好文本行前缀 "tag-//>>>"，并附带按标签统计的写入计数
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+	* @brief Handle of a tag registered with LightLogWrite_Impl::RegisterTag
+	* @details A distinct type so an integer is never taken for a tag by accident. kNoLogTagId marks
+	* * records whose tag name is stored inline instead.
+	*/
+enum class LogTagId : uint32_t {};
+
+constexpr LogTagId kNoLogTagId{ 0 };
+
+/**
+	* @brief One registered tag
+	*/
+struct LightLogTagEntry {
+	std::string            sTagName;            /*!< UTF-8 tag name                        */
+	std::string            sLinePrefix;         /*!< Pre-encoded "tag-//>>>" text prefix   */
+	std::atomic<uint64_t>  writtenCount{ 0 };   /*!< Records written with this tag         */
+};
+
+/**
+	* @brief Interns tag names and hands out LogTagId values
+	* @details Registering takes a mutex and is meant to happen once per tag, e.g. at start up.
+	* * Resolving an id is a plain array index without any lock: entries live in a fixed array that is
+	* * never reallocated, and an id can only reach the write thread through the log queue, which orders
+	* * the registration before the lookup.
+	*/
+class LightLogTagRegistry {
+public:
+	static constexpr size_t kMaxTags = 1024;  /*!< Registering more distinct tags throws */
+
+	LightLogTagRegistry();
+
+	LightLogTagRegistry(const LightLogTagRegistry&) = delete;
+	LightLogTagRegistry& operator=(const LightLogTagRegistry&) = delete;
+
+	/**
+		* @brief Registers a tag, registering the same name again returns the same id
+		* @param sTagName UTF-8 tag name
+		* @return The tag id, never kNoLogTagId
+		* @throw std::length_error if more than kMaxTags distinct tags are registered
+		*/
+	LogTagId Register(std::string_view sTagName);
+
+	/**
+		* @brief Resolves an id returned by Register
+		*/
+	LightLogTagEntry& Get(LogTagId tagId) { return pEntries[static_cast<uint32_t>(tagId) - 1]; }
+	const LightLogTagEntry& Get(LogTagId tagId) const { return pEntries[static_cast<uint32_t>(tagId) - 1]; }
+
+	/**
+		* @brief Checks that an id was returned by this registry
+		*/
+	bool Contains(LogTagId tagId) const
+	{
+		uint32_t index = static_cast<uint32_t>(tagId);
+		return index != 0 && index <= tagCount.load(std::memory_order_acquire);
+	}
+
+	size_t Size() const { return tagCount.load(std::memory_order_acquire); }
+
+private:
+	std::mutex                                 pRegisterMutex;  /*!< Serializes Register               */
+	std::unordered_map<std::string, LogTagId>  mTagIds;         /*!< Name to id                        */
+	std::unique_ptr<LightLogTagEntry[]>        pEntries;        /*!< kMaxTags entries, id - 1 is index */
+	std::atomic<uint32_t>                      tagCount;        /*!< Number of registered tags         */
+};
+
+#endif // !INCLUDE_LIGHTLOGTAGREGISTRY_H_
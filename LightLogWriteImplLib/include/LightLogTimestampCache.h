@@ -0,0 +1,175 @@
+#ifndef INCLUDE_LIGHTLOGTIMESTAMPCACHE_H_
+#define INCLUDE_LIGHTLOGTIMESTAMPCACHE_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogTimestampCache.h
+ *  @brief    写线程使用的时间戳缓存：秒数不变时只改写微秒位，复用已渲染好的 "YYYY-MM-DD HH:MM:SS"
+ *  @details  本地时间由缓存的 UTC 偏移加上公历日期换算得到，只有每 15 分钟刷新偏移时才调用一次 localtime
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <string_view>
+
+/**
+	* @brief Renders local "YYYY-MM-DD HH:MM:SS.uuuuuu" timestamps for a single thread
+	* @details Update() writes the microsecond digits and is otherwise one compare while the second
+	* * does not change. It rewrites the two second digits when only the second changed, and does the
+	* * full civil date conversion once a minute.
+	* * The UTC offset is taken from localtime once per kOffsetRefreshSeconds, which follows DST
+	* * changes since every time zone switches on a quarter hour. Not thread safe.
+	*/
+class LightLogTimestampCache {
+public:
+	static constexpr size_t  kTextSize = 26;              /*!< Length of "YYYY-MM-DD HH:MM:SS.uuuuuu" */
+	static constexpr int64_t kOffsetRefreshSeconds = 900; /*!< UTC offset is re-read this often           */
+
+	/**
+		* @brief Moves the cache to sNow, re-rendering only what changed since the last call
+		*/
+	void Update(std::chrono::system_clock::time_point sNow)
+	{
+		int64_t utcMicros = std::chrono::floor<std::chrono::microseconds>(sNow.time_since_epoch()).count();
+		int64_t utcSecond = FloorDiv(utcMicros, 1000000);
+		int micros = static_cast<int>(utcMicros - utcSecond * 1000000);
+		WriteTwoDigits(aText + 20, micros / 10000);
+		WriteTwoDigits(aText + 22, (micros / 100) % 100);
+		WriteTwoDigits(aText + 24, micros % 100);
+		if (utcSecond == cachedUtcSecond)
+			return;
+		cachedUtcSecond = utcSecond;
+		if (utcSecond >= offsetValidUntil)
+			RefreshUtcOffset(utcSecond);
+
+		int64_t localSecond = utcSecond + utcOffsetSeconds;
+		int64_t localMinute = FloorDiv(localSecond, 60);
+		WriteTwoDigits(aText + 17, static_cast<int>(localSecond - localMinute * 60));
+		if (localMinute == cachedLocalMinute)
+			return;
+		cachedLocalMinute = localMinute;
+
+		int64_t days = FloorDiv(localSecond, 86400);
+		int secondOfDay = static_cast<int>(localSecond - days * 86400);
+		int64_t year;
+		unsigned month, day;
+		CivilFromDays(days, year, month, day);
+		localHour = secondOfDay / 3600;
+
+		int yearValue = static_cast<int>(year);
+		WriteTwoDigits(aText, yearValue / 100);
+		WriteTwoDigits(aText + 2, yearValue % 100);
+		aText[4] = '-';
+		WriteTwoDigits(aText + 5, static_cast<int>(month));
+		aText[7] = '-';
+		WriteTwoDigits(aText + 8, static_cast<int>(day));
+		aText[10] = ' ';
+		WriteTwoDigits(aText + 11, localHour);
+		aText[13] = ':';
+		WriteTwoDigits(aText + 14, (secondOfDay / 60) % 60);
+		aText[16] = ':';
+		aText[19] = '.';
+	}
+
+	/**
+		* @brief Timestamp of the last Update, valid until the next one
+		*/
+	std::string_view GetText() const { return std::string_view(aText, kTextSize); }
+
+	/**
+		* @brief Local hour (0-23) of the last Update
+		*/
+	int GetLocalHour() const { return localHour; }
+
+	/**
+		* @brief Days since 1970-01-01 of a proleptic Gregorian date
+		*/
+	static constexpr int64_t DaysFromCivil(int64_t year, unsigned month, unsigned day)
+	{
+		year -= month <= 2;
+		const int64_t era = (year >= 0 ? year : year - 399) / 400;
+		const unsigned yoe = static_cast<unsigned>(year - era * 400);
+		const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+		const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+		return era * 146097 + static_cast<int64_t>(doe) - 719468;
+	}
+
+	/**
+		* @brief Inverse of DaysFromCivil
+		*/
+	static constexpr void CivilFromDays(int64_t days, int64_t& year, unsigned& month, unsigned& day)
+	{
+		days += 719468;
+		const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+		const unsigned doe = static_cast<unsigned>(days - era * 146097);
+		const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+		const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+		const unsigned mp = (5 * doy + 2) / 153;
+		day = doy - (153 * mp + 2) / 5 + 1;
+		month = mp < 10 ? mp + 3 : mp - 9;
+		year = static_cast<int64_t>(yoe) + era * 400 + (month <= 2);
+	}
+
+private:
+	static constexpr int64_t FloorDiv(int64_t value, int64_t divisor)
+	{
+		int64_t quotient = value / divisor;
+		return (value % divisor < 0) ? quotient - 1 : quotient;
+	}
+
+	static void WriteTwoDigits(char* pOut, int value)
+	{
+		pOut[0] = static_cast<char>('0' + value / 10);
+		pOut[1] = static_cast<char>('0' + value % 10);
+	}
+
+	void RefreshUtcOffset(int64_t utcSecond)
+	{
+		std::time_t sUtcTime = static_cast<std::time_t>(utcSecond);
+		std::tm sLocalTm;
+#ifdef _WIN32
+		localtime_s(&sLocalTm, &sUtcTime);
+#else
+		localtime_r(&sUtcTime, &sLocalTm);
+#endif
+		int64_t localSecond = DaysFromCivil(sLocalTm.tm_year + 1900, static_cast<unsigned>(sLocalTm.tm_mon + 1), static_cast<unsigned>(sLocalTm.tm_mday)) * 86400
+			+ sLocalTm.tm_hour * 3600 + sLocalTm.tm_min * 60 + sLocalTm.tm_sec;
+		utcOffsetSeconds = localSecond - utcSecond;
+		offsetValidUntil = (FloorDiv(utcSecond, kOffsetRefreshSeconds) + 1) * kOffsetRefreshSeconds;
+		cachedLocalMinute = std::numeric_limits<int64_t>::min();
+	}
+
+	int64_t  cachedUtcSecond = std::numeric_limits<int64_t>::min();   /*!< Second of the last Update          */
+	int64_t  cachedLocalMinute = std::numeric_limits<int64_t>::min(); /*!< Local minute aText was rendered for */
+	int64_t  offsetValidUntil = std::numeric_limits<int64_t>::min();  /*!< Next UTC offset refresh, UTC second */
+	int64_t  utcOffsetSeconds = 0;                                    /*!< Local time minus UTC                */
+	int      localHour = 0;                                           /*!< Hour of the last Update             */
+	char     aText[kTextSize] = {};                                   /*!< Rendered timestamp, not terminated  */
+};
+
+#endif // !INCLUDE_LIGHTLOGTIMESTAMPCACHE_H_
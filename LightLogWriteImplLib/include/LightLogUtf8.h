@@ -0,0 +1,123 @@
+#ifndef INCLUDE_LIGHTLOGUTF8_H_
+#define INCLUDE_LIGHTLOGUTF8_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogUtf8.h
+ *  @brief    宽字符 / UTF-16 到 UTF-8 的无分配转换
+ *  @details  日志队列和日志文件统一使用 UTF-8，只有宽字符接口需要经过这里转换
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace LightLogUtf8Detail {
+
+	inline void AppendCodePoint(std::string& sOut, uint32_t cp)
+	{
+		if (cp < 0x80) {
+			sOut += static_cast<char>(cp);
+		}
+		else if (cp < 0x800) {
+			sOut += static_cast<char>(0xC0 | (cp >> 6));
+			sOut += static_cast<char>(0x80 | (cp & 0x3F));
+		}
+		else if (cp < 0x10000) {
+			sOut += static_cast<char>(0xE0 | (cp >> 12));
+			sOut += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			sOut += static_cast<char>(0x80 | (cp & 0x3F));
+		}
+		else {
+			sOut += static_cast<char>(0xF0 | (cp >> 18));
+			sOut += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+			sOut += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			sOut += static_cast<char>(0x80 | (cp & 0x3F));
+		}
+	}
+
+	/**
+		* @brief Encodes count code units returned by loadUnit(i), pairing UTF-16 surrogates when units are 16 bit
+		*/
+	template <size_t kUnitSize, typename LoadT>
+	void AppendUnits(std::string& sOut, size_t count, LoadT loadUnit)
+	{
+		for (size_t i = 0; i < count; ++i) {
+			uint32_t cp = loadUnit(i);
+			if (cp < 0x80) {
+				// ASCII fast path, the common case for tags and most messages
+				sOut += static_cast<char>(cp);
+				continue;
+			}
+			if constexpr (kUnitSize == 2) {
+				if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < count) {
+					uint32_t low = loadUnit(i + 1);
+					if (low >= 0xDC00 && low <= 0xDFFF) {
+						cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+						++i;
+					}
+				}
+			}
+			AppendCodePoint(sOut, cp);
+		}
+	}
+}
+
+/**
+	* @brief Appends wide text as UTF-8, wchar_t is UTF-16 on Windows and UCS-4 elsewhere
+	*/
+inline void AppendUtf8(std::string& sOut, std::wstring_view sInput)
+{
+	LightLogUtf8Detail::AppendUnits<sizeof(wchar_t)>(sOut, sInput.size(), [&](size_t i) {
+		return static_cast<uint32_t>(sInput[i]);
+		});
+}
+
+/**
+	* @brief Appends UTF-16 text as UTF-8
+	*/
+inline void AppendUtf8(std::string& sOut, std::u16string_view sInput)
+{
+	LightLogUtf8Detail::AppendUnits<2>(sOut, sInput.size(), [&](size_t i) {
+		return static_cast<uint32_t>(sInput[i]);
+		});
+}
+
+/**
+	* @brief Appends count wchar_t code units stored at a possibly unaligned address as UTF-8
+	* @details Used for wide text captured by EncodeLogArgs, which packs arguments without padding.
+	*/
+inline void AppendUtf8FromWideBytes(std::string& sOut, const char* pBytes, size_t count)
+{
+	LightLogUtf8Detail::AppendUnits<sizeof(wchar_t)>(sOut, count, [&](size_t i) {
+		wchar_t ch;
+		std::memcpy(&ch, pBytes + i * sizeof(wchar_t), sizeof(ch));
+		return static_cast<uint32_t>(ch);
+		});
+}
+
+#endif // !INCLUDE_LIGHTLOGUTF8_H_
@@ -52,6 +52,24 @@
 #include <codecvt>
 #include <stdexcept>
 #include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include "SpscRingBuffer.h"
+#include "GrowableRingQueue.h"
+#include "LightLogFormat.h"
+#include "LightLogBinaryFormat.h"
+#include "LightLogUtf8.h"
+#include "LightLogTagRegistry.h"
+#include "LightLogLevel.h"
+#include "LightLogTimestampCache.h"
+#include "LightLogClock.h"
+#include "LightLogFileSink.h"
+#include "LightLogRotation.h"
+#include "LightLogBackgroundWorker.h"
+#include "LightLogSink.h"
 
 
 
@@ -70,18 +88,86 @@
 
   /**
    * @brief Structure for log message information.
-   * @param sLogTagNameVal The tag name of the log.
-   * * It can be used to categorize or identify the log message.
-   * * such as INFO , WARNING, ERROR, etc.
-   * @param sLogContentVal The content of the log message.
-   * * It contains the actual log message that will be written to the log file.
-   * * This can include any relevant information that needs to be logged, such as error messages, status updates, etc.
+   * @details A fixed size, trivially copyable record so the queues move entries with a plain memcpy
+   * * and steady state logging never calls the allocator. The tag and the body are stored contiguously
+   * * in aInlineBytes; when they do not fit, one heap block is allocated (the spill path) and the
+   * * consumer of the record must call ReleaseSpill() once it is done with it.
+   * * Tag and message text are UTF-8, the same bytes end up in the log file.
+   * * The body is either the message text or, for a deferred record written by LightLogWrite_Impl::Log,
+   * * the raw argument bytes produced by EncodeLogArgs.
+   * * A record written with a registered tag carries only its LogTagId, tagBytes is 0 then.
+   * @param pLogFormatVal The format string of a deferred record, otherwise null.
+   * @param tagBytes Size of the tag name in bytes.
+   * @param bodyBytes Size of the message text or argument bytes in bytes.
+   * @param pSpillBytes Heap block holding tag and body when they do not fit inline, otherwise null.
+   * @param sequence Global sequence number taken at enqueue when the logger has a sequence counter, otherwise 0.
+   * @param tagId The registered tag of the record, or kNoLogTagId when the tag name is stored inline.
+   * @param aInlineBytes Inline storage of tag and body.
   */
 struct LightLogWriteInfo {
-	std::wstring                   sLogTagNameVal;  /*!< Log tag name */
-	std::wstring                   sLogContentVal;  /*!< Log content */
+	static constexpr size_t kRecordSize = 256;                                             /*!< sizeof(LightLogWriteInfo) */
+	static constexpr size_t kInlineCapacity = kRecordSize - 2 * sizeof(void*) - 2 * sizeof(uint64_t) - 3 * sizeof(uint32_t);
+
+	const wchar_t*                 pLogFormatVal = nullptr;   /*!< Deferred format string (static)  */
+	uint32_t                       tagBytes = 0;              /*!< Tag name size in bytes           */
+	uint32_t                       bodyBytes = 0;             /*!< Content / argument size in bytes */
+	char*                          pSpillBytes = nullptr;     /*!< Heap payload of oversized entries */
+	uint64_t                       enqueueTicks = 0;          /*!< LightLogClock ticks at the call   */
+	uint64_t                       sequence = 0;              /*!< See LightLogWrite_Impl::SetSequenceCounter */
+	LogTagId                       tagId = kNoLogTagId;       /*!< Registered tag, if any           */
+	char                           aInlineBytes[kInlineCapacity]; /*!< Inline tag + body payload    */
+
+	/**
+		* @brief Stores a UTF-8 tag and a UTF-8 plain message
+		*/
+	void AssignContent(std::string_view sTagName, std::string_view sContent);
+
+	/**
+		* @brief Stores a registered tag and a UTF-8 plain message
+		*/
+	void AssignContent(LogTagId registeredTag, std::string_view sContent);
+
+	/**
+		* @brief Stores a tag and reserves bodySize bytes for deferred arguments
+		* @return Pointer to the reserved body bytes
+		*/
+	char* AssignDeferred(std::string_view sTagName, const wchar_t* pszFormat, size_t bodySize);
+
+	/**
+		* @brief Stores a registered tag and reserves bodySize bytes for deferred arguments
+		* @return Pointer to the reserved body bytes
+		*/
+	char* AssignDeferred(LogTagId registeredTag, const wchar_t* pszFormat, size_t bodySize);
+
+	/**
+		* @brief Frees the spill block, the record is empty afterwards
+		*/
+	void ReleaseSpill();
+
+	const char* PayloadBytes() const { return pSpillBytes ? pSpillBytes : aInlineBytes; }
+
+	std::string_view GetTagName() const
+	{
+		return { PayloadBytes(), tagBytes };
+	}
+
+	std::string_view GetContent() const
+	{
+		return { PayloadBytes() + tagBytes, bodyBytes };
+	}
+
+	std::string_view GetArgs() const
+	{
+		return { PayloadBytes() + tagBytes, bodyBytes };
+	}
+
+private:
+	char* AssignPayload(std::string_view sTagName, size_t bodySize);
 };
 
+static_assert(sizeof(LightLogWriteInfo) == LightLogWriteInfo::kRecordSize, "LightLogWriteInfo must stay one fixed size slot");
+static_assert(std::is_trivially_copyable_v<LightLogWriteInfo>, "LightLogWriteInfo must be trivially copyable");
+
 /**
 	* @brief Enum for strategies to handle full log queues.
 	* @details
@@ -98,6 +184,60 @@ enum class LogQueueOverflowStrategy {
 	DropOldest  /*!< Drop the oldest log entry */
 };
 
+/**
+	* @brief Enum for how producer threads hand log entries to the write thread.
+	* @param SharedQueue Every producer pushes into one FIFO guarded by the log write mutex.
+	* @param ThreadLocalStaging Every producer thread lazily registers its own single-producer/single-consumer
+	* * ring and pushes into it without taking any shared lock. The write thread drains the rings round-robin.
+	* * Order is preserved per producer thread, not across threads.
+	* * When a ring is full the producer yields until the write thread frees a slot. Only the write thread
+	* * may pop from a ring, so this mode cannot drop the oldest entry and requires LogQueueOverflowStrategy::Block.
+	*/
+enum class LogWriteQueueMode {
+	SharedQueue,        /*!< One mutex protected queue      */
+	ThreadLocalStaging  /*!< One lock-free ring per thread  */
+};
+
+/**
+	* @brief Enum for the on-disk layout written by the log write thread.
+	* @param Text One "tag-//>>>YYYY-MM-DD HH:MM:SS : message" line per entry.
+	* @param Binary The compact layout described in LightLogBinaryFormat.h, lasting log files use the ".llb"
+	* * extension. Use tools/LightLogDecoder to turn such a file back into the text layout.
+	*/
+enum class LogOutputFormat {
+	Text,   /*!< Human readable lines  */
+	Binary  /*!< Compact binary record */
+};
+
+/**
+	* @brief When the write thread makes written records durable (fdatasync), see LightLogWrite_Impl::SetDurabilityPolicy
+	* @details The default never syncs on its own, the operating system writes the data back whenever it likes
+	* * and a crash of the machine loses an unknown tail. Both triggers can be combined; Flush() and
+	* * FlushAndWait() work whatever the policy is. Concurrent sync requests share one fdatasync.
+	* @param syncIntervalMs Written records are synced at most this many milliseconds later, 0 disables it.
+	* @param eSyncLevel A LIGHTLOG_WRITE / LIGHTLOG_LOG statement at or above this level requests a sync
+	* * once it is queued, like Flush(). LogLevel::Off disables it.
+	*/
+struct LogDurabilityPolicy {
+	uint32_t  syncIntervalMs = 0;          /*!< Periodic sync, 0 = never      */
+	LogLevel  eSyncLevel = LogLevel::Off;  /*!< Sync after severe statements  */
+};
+
+/**
+	* @brief Per producer thread staging ring used by LogWriteQueueMode::ThreadLocalStaging.
+	* @details The ring is shared between the producer thread (through a thread_local registry) and the
+	* * write thread. When the producer thread exits it sets bProducerExited; the write thread drains
+	* * whatever is left and then unregisters the ring. bLoggerClosed tells the producer side that the
+	* * owning logger is gone and the slot can be forgotten.
+	*/
+struct LightLogStagingBuffer {
+	explicit LightLogStagingBuffer(size_t capacity) : sRingQueue(capacity) {}
+
+	SpscRingBuffer<LightLogWriteInfo>  sRingQueue;               /*!< Entries staged by one producer   */
+	std::atomic<bool>                  bProducerExited{ false }; /*!< Producer thread has exited       */
+	std::atomic<bool>                  bLoggerClosed{ false };   /*!< Owning logger has been destroyed */
+};
+
 
 /**
  * @brief Implementation of the LightLogWrite class
@@ -112,11 +252,16 @@ public:
 		* @param reportInterval The interval for reporting log overflow
 		* @details This constructor initializes the log writer with a specified maximum queue size,
 		*          a strategy for handling full queues, and an interval for reporting log overflow.
+		* @param queueMode How producer threads hand entries to the write thread, see LogWriteQueueMode
 		* @note The default maximum queue size is 500000, the default strategy is to block when the queue is full,
 		*       and the default report interval is 100 discarded logs.
+		* * In ThreadLocalStaging mode maxQueueSize is not used, every producer thread gets a ring of
+		* * SetStagingBufferCapacity() entries instead.
+		* @throw std::invalid_argument if queueMode is ThreadLocalStaging and strategy is DropOldest
 		* @version 1.0.0
 		*/
-	LightLogWrite_Impl(size_t maxQueueSize = 500000, LogQueueOverflowStrategy strategy = LogQueueOverflowStrategy::Block, size_t reportInterval = 100);
+	LightLogWrite_Impl(size_t maxQueueSize = 500000, LogQueueOverflowStrategy strategy = LogQueueOverflowStrategy::Block, size_t reportInterval = 100,
+		LogWriteQueueMode queueMode = LogWriteQueueMode::SharedQueue);
 
 	/**
 		* @brief Destructor for LightLogWrite_Impl
@@ -152,7 +297,7 @@ public:
 		* @details This function sets the directory and base name for lasting logs.
 		* * It will create a new log file based on the current date and time.
 		* * The log files will be named in the format "BaseName_YYYY_MM_DD_AM/PM.log". such as "LightLogWriteImpl_2025_05_27_AM.log".
-		* * If the directory does not exist, it will be created.
+		* * If the directory does not exist, it will be created. SetRotationPolicy changes the period and adds size limits.
 		* @note This function should be called before writing any logs to ensure that the logs are stored correctly.
 		*/
 	void SetLastingsLogs(const std::wstring& sFilePath, const std::wstring& sBaseName);
@@ -164,18 +309,97 @@ public:
 
 	/**
 	* @brief Writes a log message with a specific type
-	* @param sTypeVal The type of the log message (e.g., "INFO", "ERROR")
-	* @param sMessage The content of the log message
+	* @param sTypeVal The type of the log message (e.g., "INFO", "ERROR"), UTF-8
+	* @param sMessage The content of the log message, UTF-8
 	* @details This function writes a log message with a specific type to the log file.
 	* It will also handle log overflow according to the specified strategy.
+	* * This is the native overload: the bytes are queued and written to the file without any transcoding.
 	*/
-	void WriteLogContent(const std::wstring& sTypeVal, const std::wstring& sMessage);
+	void WriteLogContent(std::string_view sTypeVal, std::string_view sMessage);
+
+#ifdef __cpp_char8_t
+	void WriteLogContent(std::u8string_view sTypeVal, std::u8string_view sMessage)
+	{
+		WriteLogContent(std::string_view(reinterpret_cast<const char*>(sTypeVal.data()), sTypeVal.size()),
+			std::string_view(reinterpret_cast<const char*>(sMessage.data()), sMessage.size()));
+	}
+#endif
+
+	/**
+	* @brief Writes a log message with a tag registered by RegisterTag
+	* @param tagId The tag returned by RegisterTag
+	* @param sMessage The content of the log message, UTF-8
+	* @details The record only carries the tag id, the write thread resolves it to the pre-encoded line prefix.
+	*/
+	void WriteLogContent(LogTagId tagId, std::string_view sMessage);
 
-	void WriteLogContent(const std::string& sTypeVal, const std::string& sMessage);
+	/**
+	* @brief Same as above, the wide message is converted to UTF-8 on the calling thread
+	*/
+	void WriteLogContent(LogTagId tagId, const std::wstring& sMessage);
 
+	/**
+	* @brief Writes a wide log message, it is converted to UTF-8 on the calling thread
+	*/
+	void WriteLogContent(const std::wstring& sTypeVal, const std::wstring& sMessage);
 
+	/**
+	* @brief Writes a UTF-16 log message, it is converted to UTF-8 on the calling thread
+	*/
 	void WriteLogContent(const std::u16string& sTypeVal, const std::u16string& sMessage);
 
+	/**
+	* @brief Writes a log message whose text is rendered on the write thread
+	* @param sTypeVal The type of the log message (e.g., "INFO", "ERROR"), UTF-8
+	* @param fmt A format string built with LIGHTLOG_FMT, "{}" is replaced by the next argument
+	* @param args Arithmetic values, pointers or strings, narrow strings are taken to be UTF-8.
+	* * char and wchar_t print as characters, signed char and unsigned char as numbers.
+	* @details The calling thread only copies the raw bytes of the arguments, formatting is done by RunWriteThread.
+	* * The number of placeholders is checked against the number of arguments at compile time.
+	* @code
+	* logger.Log("INFO", LIGHTLOG_FMT("Log message {} from {}"), i, sTag);
+	* @endcode
+	*/
+	template <typename FormatT, typename... Args>
+	void Log(std::string_view sTypeVal, FormatT fmt, const Args&... args);
+
+	/**
+	* @brief Same as Log above, the wide tag is converted to UTF-8 on the calling thread
+	*/
+	template <typename FormatT, typename... Args>
+	void Log(std::wstring_view sTypeVal, FormatT fmt, const Args&... args)
+	{
+		Log(ConvertTagToUtf8(sTypeVal), fmt, args...);
+	}
+
+	/**
+	* @brief Same as Log above, with a tag registered by RegisterTag
+	*/
+	template <typename FormatT, typename... Args>
+	void Log(LogTagId tagId, FormatT fmt, const Args&... args);
+
+	/**
+	* @brief Registers a tag so records only need to carry its id
+	* @param sTagName The UTF-8 tag name, e.g. "INFO"
+	* @return The tag id; registering the same name again returns the same id
+	* @details Registration takes a lock, do it once per tag (e.g. at start up) and keep the id.
+	* @throw std::length_error if more than LightLogTagRegistry::kMaxTags distinct tags are registered
+	* @code
+	* LogTagId kInfoTag = logger.RegisterTag("INFO");
+	* logger.WriteLogContent(kInfoTag, "service started");
+	* @endcode
+	*/
+	LogTagId RegisterTag(std::string_view sTagName);
+
+	LogTagId RegisterTag(const std::wstring& sTagName);
+
+	/**
+	* @brief Gets how many records with a registered tag have been written by the write thread
+	* @param tagId The tag returned by RegisterTag
+	* @return The count, or 0 if tagId was not returned by this logger
+	*/
+	uint64_t GetTagLogCount(LogTagId tagId) const;
+
 	/**
 		* @brief Gets the current discard count
 		* @return The number of discarded log messages
@@ -192,14 +416,221 @@ public:
 		*/
 	void ResetDiscardCount();
 
+	/**
+		* @brief Sets the capacity of the per thread staging rings
+		* @param capacity Number of entries per ring, rounded up to a power of two
+		* @details Only used in LogWriteQueueMode::ThreadLocalStaging and only affects
+		* * producer threads that register after the call.
+		*/
+	void SetStagingBufferCapacity(size_t capacity);
+
+	/**
+		* @brief Limits how many entries the write thread takes from the shared queue at once
+		* @param maxBatchSize Max entries per batch, 0 (default) means no limit
+		* @details In LogWriteQueueMode::SharedQueue the write thread swaps the whole pending queue for its
+		* * empty batch queue under one lock acquisition and writes the batch without holding the lock.
+		* * When more than maxBatchSize entries are pending, only that many are moved over instead.
+		*/
+	void SetMaxWriteBatchSize(size_t maxBatchSize);
+
+	/**
+		* @brief Numbers every record from a counter shared with other loggers, see LightLogShardedWrite
+		* @param pCounter Incremented once per record on the calling thread, must outlive the logger; null (default) turns numbering off
+		* @details Text lines then start with "#<sequence> ", binary records are preceded by a sequence entry.
+		* * LightLogMerge rebuilds one ordered file from the files of loggers sharing a counter.
+		*/
+	void SetSequenceCounter(std::atomic<uint64_t>* pCounter);
+
+	/**
+		* @brief Sets the on-disk layout of the log files
+		* @param eFormat Text (default) or Binary
+		* @note Only applies to files opened afterwards, call it before SetLogsFileName or SetLastingsLogs.
+		*/
+	void SetLogOutputFormat(LogOutputFormat eFormat);
+
+	/**
+		* @brief Sets the size of the write thread's file buffer
+		* @param bufferSize Bytes, LightLogFileSink::kDefaultBufferSize (1 MiB) by default, 1-4 MiB suits busy logs
+		* @details The write thread appends formatted records to this buffer and calls write once the buffer
+		* * is full or the current batch is done, so larger buffers mean fewer system calls under load.
+		* @note Only applies to files opened afterwards, call it before SetLogsFileName or SetLastingsLogs.
+		*/
+	void SetWriteBufferSize(size_t bufferSize);
+
+	/**
+		* @brief Selects how the write thread hands full buffers to the kernel
+		* @param eMode Write (default), IoUring or Mmap
+		* @details With IoUring (Linux) the write thread submits a full buffer and keeps formatting into the
+		* * next one, so a slow disk only stalls it once all LightLogIoUring::kInFlightBuffers buffers are
+		* * in flight. Where io_uring cannot be set up the sink quietly uses write, GetSinkStats().asyncWrites
+		* * stays 0 then.
+		* * With Mmap (POSIX) records are copied into preallocated segment files of SetMmapSegmentSize bytes,
+		* * name.log, name.1.log, name.2.log ..., and GetSinkStats().writeCalls stays 0. Binary files start
+		* * every segment with a segment header so each one decodes on its own.
+		* @note Only applies to files opened afterwards, call it before SetLogsFileName or SetLastingsLogs.
+		*/
+	void SetFileSinkMode(LogFileSinkMode eMode);
+
+	/**
+		* @brief Sets the size of each segment file in LogFileSinkMode::Mmap
+		* @param segmentSize Bytes, LightLogFileSink::kDefaultSegmentSize (256 MiB) by default, at least 1 MiB
+		* @note Only applies to files opened afterwards, call it before SetLogsFileName or SetLastingsLogs.
+		*/
+	void SetMmapSegmentSize(size_t segmentSize);
+
+	/**
+		* @brief Compresses log files while they are written, in independent frames of frameSize bytes
+		* @param eCompression LogCompression::Gzip needs zlib (LIGHTLOG_HAVE_ZLIB), None (default) turns it off
+		* @param frameSize Uncompressed bytes per frame, LightLogFrameFormat::kDefaultFrameSize (64 KiB) by default
+		* @details Every frame is a gzip member of its own, so zcat reads the file, and a frame is ended once it
+		* * is full or has been open for LightLogFrameEncoder::kMaxFrameDelay. Closing a file appends an index
+		* * of frame offsets and first timestamps, LightLogFrameFormat::ReadFrameIndex and ReadFrame use it to
+		* * decompress any frame alone. Lasting log files get a ".gz" suffix; records still in an open frame
+		* * are lost if the process dies. LogFileSinkMode::Mmap falls back to Write, and LogRotationPolicy::maxFileBytes
+		* * counts the uncompressed bytes of the open file.
+		* @note Only applies to files opened afterwards, call it before SetLogsFileName or SetLastingsLogs.
+		*/
+	void SetStreamCompression(LogCompression eCompression, size_t frameSize = LightLogFrameFormat::kDefaultFrameSize);
+
+	/**
+		* @brief Gets the system call and byte counters of the log file sink
+		*/
+	LightLogSinkStats GetSinkStats() const;
+
+	static constexpr size_t kDefaultLogSinkCapacity = 1u << 16;  /*!< Lines queued per attached sink */
+
+	/**
+		* @brief Attaches another output next to the log file, e.g. LightLogStreamSink (stderr) or LightLogMemorySink
+		* @param capacity Lines queued for this sink before eStrategy applies
+		* @param eStrategy DropOldest drops the sink's oldest batches, Block makes the write thread wait for it
+		* @return Id for RemoveLogSink and GetLogSinkStats
+		* @details Every sink has its own queue and thread. The write thread formats each record into a text
+		* * line once, also when the file is binary or none is open, and hands every batch to all sinks by
+		* * reference count; a slow sink only falls behind on its own queue. Sinks see records from the
+		* * next batch on.
+		*/
+	size_t AddLogSink(std::shared_ptr<LightLogSink> pSink, size_t capacity = kDefaultLogSinkCapacity,
+		LogQueueOverflowStrategy eStrategy = LogQueueOverflowStrategy::DropOldest);
+
+	/**
+		* @brief Detaches a sink after it has written what is queued for it
+		* @return false if sinkId is not attached
+		*/
+	bool RemoveLogSink(size_t sinkId);
+
+	/**
+		* @brief Gets the line counters of an attached sink, all zero if sinkId is not attached
+		*/
+	LightLogSinkChannelStats GetLogSinkStats(size_t sinkId) const;
+
+	/**
+		* @brief Sets the runtime threshold used by LIGHTLOG_WRITE / LIGHTLOG_LOG
+		* @param eLevel Statements below this level are skipped, LogLevel::Off skips everything
+		* @note Statements below LIGHTLOG_MIN_LEVEL are removed at compile time whatever this is set to.
+		*/
+	void SetLogLevel(LogLevel eLevel);
+
+	LogLevel GetLogLevel() const;
+
+	/**
+		* @brief Checks a level against the runtime threshold, costs one relaxed atomic load
+		*/
+	bool IsLevelEnabled(LogLevel eLevel) const
+	{
+		return eLevel >= eMinLogLevel.load(std::memory_order_relaxed);
+	}
+
+	/**
+		* @brief Sets when written records are synced to disk
+		* @details Also applies to the open file. With any trigger set, a log file is synced before it is closed.
+		*/
+	void SetDurabilityPolicy(const LogDurabilityPolicy& sPolicy);
+
+	LogDurabilityPolicy GetDurabilityPolicy() const;
+
+	/**
+		* @brief Checks whether a statement of this level requests a sync, used by LIGHTLOG_WRITE / LIGHTLOG_LOG
+		*/
+	bool IsSyncLevel(LogLevel eLevel) const
+	{
+		return eLevel >= eSyncLevel.load(std::memory_order_relaxed);
+	}
+
+	/**
+		* @brief Asks the write thread to sync every record queued so far, does not wait
+		*/
+	void Flush();
+
+	/**
+		* @brief Returns once every record queued before the call is on disk
+		* @details Records queued by other threads before this call are covered too. The caller waits for the
+		* * write thread to catch up and sync, requests that arrive meanwhile are served by the same fdatasync.
+		* * Covers the file open when the write thread catches up, a file closed before that is only
+		* * durable if a durability policy is set. Returns at once after the write thread has stopped.
+		*/
+	void FlushAndWait();
+
+	/**
+		* @brief Sets how lasting log files are rotated and how many old ones are kept, see LogRotationPolicy
+		* @details Takes effect at once: the next record goes to the file of the new period. The default
+		* * rotates at 00:00 and 12:00, keeps every file and compresses none. Has no effect on SetLogsFileName files.
+		* * A changed compressionThreads waits for the compressions already queued.
+		*/
+	void SetRotationPolicy(const LogRotationPolicy& sPolicy);
+
+	LogRotationPolicy GetRotationPolicy();
+
 private:
 	/**
-		* @brief Builds the output log file name based on the current date and time
+		* @brief Queues an entry according to the queue mode and overflow strategy
+		* @details Shared by every WriteLogContent overload and Log.
+		*/
+	void EnqueueLogRecord(LightLogWriteInfo&& sLogMessageInf);
+
+	/**
+		* @brief Converts a wide tag to UTF-8 in a thread local buffer
+		* @return A view that stays valid until the calling thread's next call
+		*/
+	static std::string_view ConvertTagToUtf8(std::wstring_view sTypeVal);
+
+	/**
+		* @brief Builds the output log file name for the rotation period sNow is in
 		* @return A wide string representing the log file name
-		* @details This function constructs the log file name using the current date and time.
-		* * The format is "BaseName_YYYY_MM_DD_AM/PM.log", where BaseName is the base name set by SetLastingsLogs.
+		* @details The format is "BaseName<period>[-N].log", e.g. "BaseName_YYYY_MM_DD_AM.log", where BaseName is
+		* * the base name set by SetLastingsLogs and N the first index whose file is below maxFileBytes.
+		* * Also sets sRotationDeadline for the period. The caller holds pLogFileMutex and pPreparedMutex.
+		*/
+	std::wstring BuildLogFileOut(std::chrono::system_clock::time_point sNow);
+
+	/**
+		* @brief Index 0 lasting log file of the rotation period sNow is in
+		*/
+	std::filesystem::path PeriodLogFilePath(std::chrono::system_clock::time_point sNow) const;
+
+	/**
+		* @brief Bytes a log file held before this logger opened it, 0 if it does not exist; caller holds pPreparedMutex
+		*/
+	uint64_t ExistingLogFileBytes(const std::filesystem::path& sPath) const;
+
+	/**
+		* @brief Has sFileWorker open sFileName with the current sink settings, the caller holds pLogFileMutex
+		* @details The write thread asks for it kPreopenLead before the period deadline or once the file is
+		* * within an eighth of maxFileBytes. If the rotation then picks that file, CreateLogsFile adopts it
+		* * and only swaps handles; otherwise the prepared file is discarded and the file opened as usual.
+		*/
+	void PrepareNextLogFile(const std::wstring& sFileName);
+
+	/**
+		* @brief Closes the prepared file and removes it again if it was created empty, caller holds pPreparedMutex
 		*/
-	std::wstring BuildLogFileOut();
+	void DiscardPreparedFile();
+
+	/**
+		* @brief Queues the compression of a lasting log file rotation has closed, and of its mmap segments
+		* @details Runs on pCompressionWorker at idle priority, so it never competes with the write thread.
+		* * The caller holds pLogFileMutex.
+		*/
+	void CompressClosedFile(const std::wstring& sFileName);
 
 
 	/**
@@ -212,17 +643,25 @@ private:
 	void CloseLogStream();
 
 	/**
-		* @brief Creates a new log file based on the current date and time
-		* @details This function constructs a new log file name using the current date and time,
+		* @brief Creates a new log file for the rotation period sNow is in
+		* @details This function constructs a new log file name with BuildLogFileOut,
 		* * checks if the directory exists, and opens the log file stream for appending.
-		* * If the directory does not exist, it will be created.
+		* * If the directory does not exist, it will be created. Retention is then applied on sFileWorker.
+		* @note The caller holds pLogFileMutex.
 		*/
-	void CreateLogsFile();
+	void CreateLogsFile(std::chrono::system_clock::time_point sNow);
+
+	/**
+		* @brief Opens the log file sink in the current output format, binary files start a new segment
+		* @param sFilename The full path of the log file
+		* @param pPreparedSink sFilename opened ahead of time, adopted instead of opening it again
+		*/
+	void OpenLogFileSink(const std::wstring& sFilename, LightLogFileSink* pPreparedSink = nullptr);
 
 	/**
 		* @brief Runs the log writing thread
 		* @details This function runs in a separate thread and continuously checks for new log messages to write.
-		* * It waits for new log messages to be added to the queue and writes them to the log file.
+		* * It waits for new log messages to be added to the queue, takes them as one batch and writes them to the log file.
 		* * If the log file needs to be created or rotated, it will handle that as well.
 		* * The thread will exit when the stop flag is set and the queue is empty.
 		* @note This function should be called in a separate thread to avoid blocking the main application.
@@ -230,57 +669,198 @@ private:
 	void RunWriteThread();
 
 	/**
-		* @brief Checks if the directory for the log file exists, and creates it if it does not
-		* @param sFilename The full path of the log file
-		* @details This function checks if the directory of the specified log file exists.
-		* * If the directory does not exist, it will create all necessary directories.
+		* @brief Write thread loop for LogWriteQueueMode::ThreadLocalStaging
+		* @details Drains the registered staging rings round-robin, at most kStagingDrainBurst entries
+		* * per ring and pass, and parks on pWrittenCondVar when every ring is empty.
+		* * Rings whose producer thread has exited are unregistered once they are empty.
 		*/
-	void ChecksDirectory(const std::wstring& sFilename);
+	void RunStagingWriteThread();
 
 	/**
-		* @brief Gets the current time as a formatted string
-		* @return A wide string representing the current time in the format "YYYY-MM-DD HH:MM:SS"
-		* @details This function retrieves the current system time and formats it into a wstring.
-		* * The format used is "YYYY-MM-DD HH:MM:SS", which is suitable for logging purposes.
+		* @brief Pushes an entry into the calling thread's staging ring, waiting while it is full
 		*/
-	std::wstring GetCurrentTimer() const;
+	void PushStagingLog(LightLogWriteInfo&& sLogMessageInf);
 
 	/**
-		* @brief Gets the current time as a tm structure
-		* @return A tm structure representing the current time
-		* @details This function retrieves the current system time and converts it into a tm structure.
-		* * The tm structure contains various components of the time, such as year, month, day, hour, minute, and second.
-		* * This is useful for formatting or manipulating time data in a more structured way.
-		* @note The tm structure is in local time, so it will reflect the local timezone settings of the system.
-		* @retval std::tm The current time as a tm structure
-		* @version 1.0.0
+		* @brief Gets the staging ring of the calling thread, registering one on first use
+		*/
+	LightLogStagingBuffer* GetThreadStagingBuffer();
+
+	/**
+		* @brief Writes a single entry to the log file, rotating it first when needed
+		*/
+	void WriteLogRecord(const LightLogWriteInfo& sLogMessageInf);
+
+	/**
+		* @brief Picks up attached or removed sinks and starts the batch WriteLogRecord adds their lines to
+		* @details Write thread only, under pLogFileMutex. pSinkBatch stays null when no sink is attached.
+		*/
+	void BeginSinkBatch();
+
+	/**
+		* @brief Hands the lines of the batch to every attached sink
 		*/
-	std::tm GetCurrsTimerTm() const;
+	void PublishSinkBatch();
+
+	/**
+		* @brief Rotates the lasting log file when the period deadline passed or the file reached maxFileBytes
+		* @details One time compare and one size compare per record, both limits are precomputed.
+		*/
+	void ChecksLogRotation(std::chrono::system_clock::time_point sNow);
+
+	/**
+		* @brief Wakes the write thread for a sync of everything queued so far
+		* @return The ticket that is served once that sync is done
+		*/
+	uint64_t RequestSync();
+
+	/**
+		* @brief Syncs the log file when a request or the sync interval is due, caller holds pLogFileMutex
+		* @param syncTicket syncRequestCount as read before the write thread last looked for records
+		* @param bCaughtUp Every record queued before syncTicket was read has been written
+		*/
+	void SyncLogFile(uint64_t syncTicket, bool bCaughtUp);
+
+	/**
+		* @brief Final sync of the write thread, releases every FlushAndWait caller, caller holds pLogFileMutex
+		*/
+	void FinishSyncRequests();
+
+	bool HasDurabilityPolicy() const
+	{
+		return syncIntervalMs.load(std::memory_order_relaxed) != 0 || eSyncLevel.load(std::memory_order_relaxed) != LogLevel::Off;
+	}
+
+	/**
+		* @brief Checks if the directory for the log file exists, and creates it if it does not
+		* @param sFilename The full path of the log file
+		* @details This function checks if the directory of the specified log file exists.
+		* * If the directory does not exist, it will create all necessary directories.
+		*/
+	void ChecksDirectory(const std::wstring& sFilename);
+
 
 private:
 	//------------------------------------------------------------------------------------------------
 	// Section Name: Private Members @{                                                              +
 	//------------------------------------------------------------------------------------------------
-	std::wofstream                  pLogFileStream;            /*!< Log file stream                  */
+	LightLogSinkCounters            sSinkCounters;             /*!< Shared by pLogFileSink and prepared sinks */
+	LightLogFileSink                pLogFileSink;              /*!< Buffered log file, raw bytes     */
+	std::mutex                      pLogFileMutex;             /*!< Guards pLogFileSink: write thread vs. file (re)opening */
 	std::mutex                      pLogWriteMutex;            /*!< Log write mutex                  */
-	std::queue<LightLogWriteInfo>  pLogWriteQueue;             /*!< Log write queue FIFO             */
+	GrowableRingQueue<LightLogWriteInfo> pLogWriteQueue;       /*!< Log write queue FIFO             */
 	std::condition_variable         pWrittenCondVar;           /*!< Cond for waking log write thread */
 	std::thread                     sWrittenThreads;           /*!< Log write thread                 */
 	std::atomic<bool>               bIsStopLogging;            /*!< Stop flag                        */
 	std::wstring                    sLogLastingDir;            /*!< Directory for lasting logs       */
 	std::wstring                    sLogsBasedName;            /*!< Base name for log files          */
 	std::atomic<bool>               bHasLogLasting;            /*!< Whether to persist logs          */
-	std::atomic<bool>               bLastingTmTags;            /*!< Current log file AM/PM tag       */
 	const size_t                    kMaxQueueSize;             /*!< Max queue size                   */
 	LogQueueOverflowStrategy        queueFullStrategy;         /*!< Queue full strategy              */
 	std::atomic<size_t>             discardCount;              /*!< Discard count                    */
 	std::atomic<size_t>             lastReportedDiscardCount;  /*!< Last reported discard count      */
 	std::atomic<size_t>             reportInterval;            /*!< Report interval                  */
+	const LogWriteQueueMode         eQueueMode;                /*!< Producer hand-off mode           */
+	const uint64_t                  kInstanceId;               /*!< Key of this logger in thread registries */
+	std::mutex                      pStagingMutex;             /*!< Guards pStagingBuffers           */
+	std::vector<std::shared_ptr<LightLogStagingBuffer>> pStagingBuffers; /*!< Registered staging rings  */
+	std::atomic<size_t>             stagingGeneration;         /*!< Bumped on every registration     */
+	std::atomic<size_t>             stagingCapacity;           /*!< Capacity of new staging rings    */
+	std::atomic<bool>               bStagingWriterParked;      /*!< Write thread waits for entries   */
+	static constexpr size_t         kStagingDrainBurst = 256;  /*!< Max entries per ring and pass    */
+	std::string                     sLineBuffer;               /*!< Write thread line buffer         */
+	std::atomic<LogOutputFormat>    eOutputFormat;             /*!< On-disk layout of new files      */
+	LightLogBinary::LightLogBinaryEncoder sBinaryEncoder;      /*!< Binary record encoder            */
+	LightLogTagRegistry             sTagRegistry;              /*!< Registered tags                  */
+	const LogTagId                  kOverflowTagId;            /*!< "LOG_OVERFLOW" tag               */
+	std::atomic<LogLevel>           eMinLogLevel;              /*!< Runtime level threshold          */
+	std::atomic<size_t>             maxWriteBatchSize;         /*!< Max entries per write batch      */
+	std::atomic<std::atomic<uint64_t>*> pSequenceCounter;      /*!< Numbers records, may be null     */
+	std::string                     sBinaryBuffer;             /*!< Write thread encode buffer       */
+	LightLogTimestampCache          sTimestampCache;           /*!< Write thread line timestamp      */
+	LightLogClock                   sLogClock;                 /*!< Converts record ticks, write thread only */
+	LogOutputFormat                 eOpenFileFormat;           /*!< Format of the open log file      */
+	std::atomic<size_t>             writeBufferSize;           /*!< Sink buffer size for new files   */
+	std::atomic<LogFileSinkMode>    eFileSinkMode;             /*!< Sink mode for new files          */
+	std::atomic<size_t>             mmapSegmentSize;           /*!< Mmap segment size for new files  */
+	std::atomic<LogCompression>     eStreamCompression;        /*!< Frame compression of new files   */
+	std::atomic<size_t>             streamFrameSize;           /*!< Frame size for new files         */
+	std::atomic<uint32_t>           syncIntervalMs;            /*!< LogDurabilityPolicy::syncIntervalMs */
+	std::atomic<LogLevel>           eSyncLevel;                /*!< LogDurabilityPolicy::eSyncLevel  */
+	std::atomic<uint64_t>           syncRequestCount;          /*!< Sync tickets handed out, bumped under pLogWriteMutex */
+	uint64_t                        completedSyncTicket;       /*!< Last ticket served, set under pSyncMutex */
+	bool                            bSyncWriterExited;         /*!< No more tickets will be served   */
+	std::mutex                      pSyncMutex;                /*!< Guards the two members above     */
+	std::condition_variable         pSyncCondVar;              /*!< FlushAndWait callers wait here   */
+	bool                            bUnsyncedWrites;           /*!< Write thread wrote since its last sync */
+	std::chrono::steady_clock::time_point sUnsyncedSince;      /*!< First write after the last sync  */
+	LogRotationPolicy               sRotationPolicy;           /*!< Guarded by pLogFileMutex, like the members below */
+	std::chrono::system_clock::time_point sRotationDeadline;   /*!< End of the current period, max() when not lasting */
+	uint64_t                        rotationMaxBytes;          /*!< maxFileBytes, UINT64_MAX when off */
+	uint64_t                        currentFileBytes;          /*!< Size of the open lasting log file */
+	std::wstring                    sPeriodFileName;           /*!< Lasting file name of index 0     */
+	size_t                          rotationIndex;             /*!< Size rotation index in the period */
+	std::chrono::system_clock::time_point sRotationCheckAt;    /*!< When the write thread looks at rotation again */
+	uint64_t                        rotationCheckBytes;        /*!< File size at which it does       */
+	static constexpr std::chrono::seconds kPreopenLead{ 5 };   /*!< Next period's file is opened this early */
+	/**
+		* @brief A lasting log file opened on sFileWorker ahead of the rotation
+		*/
+	struct PreparedLogFile {
+		std::wstring                       sFileName;          /*!< Path the sink has open           */
+		uint64_t                           fileBytes = 0;      /*!< File size before it was opened   */
+		std::unique_ptr<LightLogFileSink>  pSink;              /*!< Shares sSinkCounters             */
+	};
+	std::mutex                      pPreparedMutex;            /*!< Guards the two members below     */
+	std::wstring                    sPreparingFileName;        /*!< Requested file, cleared when the rotation comes first */
+	PreparedLogFile                 sPreparedFile;             /*!< Ready for CreateLogsFile         */
+	std::wstring                    sLastingFileName;          /*!< Lasting file last opened, guarded by pLogFileMutex */
+	std::unique_ptr<LightLogBackgroundWorker> pCompressionWorker; /*!< Idle priority, created on first use */
+	LightLogBackgroundWorker        sFileWorker;               /*!< Deletes old files off the write thread */
+	/**
+		* @brief A sink attached with AddLogSink
+		*/
+	struct AttachedLogSink {
+		size_t                               sinkId;           /*!< Returned by AddLogSink          */
+		std::shared_ptr<LightLogSinkChannel> pChannel;         /*!< Queue and thread of the sink    */
+	};
+	mutable std::mutex              pLogSinkMutex;             /*!< Guards the two members below     */
+	std::vector<AttachedLogSink>    vLogSinks;                 /*!< Attached sinks                   */
+	size_t                          nextLogSinkId;             /*!< Id of the next attached sink     */
+	std::atomic<size_t>             logSinkGeneration;         /*!< Bumped when vLogSinks changes    */
+	size_t                          writerSinkGeneration;      /*!< Generation of vWriterSinkChannels */
+	std::vector<std::shared_ptr<LightLogSinkChannel>> vWriterSinkChannels; /*!< Write thread copy of the channels */
+	std::shared_ptr<LightLogSinkBatch> pSinkBatch;             /*!< Lines of the batch being written */
 	//------------------------------------------------------------------------------------------------
 	// @} End of Private Members                                                                     +
 	//------------------------------------------------------------------------------------------------
 };
 
+template <typename FormatT, typename... Args>
+void LightLogWrite_Impl::Log(std::string_view sTypeVal, FormatT fmt, const Args&... args)
+{
+	static_assert(std::is_base_of_v<LightLogFormatString, FormatT>, "Log format strings must be built with LIGHTLOG_FMT");
+	static_assert(CountFormatPlaceholders(FormatT::value()) != static_cast<size_t>(-1), "Unmatched '{' or '}' in log format string");
+	static_assert(CountFormatPlaceholders(FormatT::value()) == sizeof...(Args), "Log format placeholder count does not match argument count");
+
+	LightLogWriteInfo sLogMessageInf;
+	char* pArgsBytes = sLogMessageInf.AssignDeferred(sTypeVal, FormatT::value(), LogArgsSize(args...));
+	EncodeLogArgs(pArgsBytes, args...);
+	EnqueueLogRecord(std::move(sLogMessageInf));
+}
+
+template <typename FormatT, typename... Args>
+void LightLogWrite_Impl::Log(LogTagId tagId, FormatT fmt, const Args&... args)
+{
+	static_assert(std::is_base_of_v<LightLogFormatString, FormatT>, "Log format strings must be built with LIGHTLOG_FMT");
+	static_assert(CountFormatPlaceholders(FormatT::value()) != static_cast<size_t>(-1), "Unmatched '{' or '}' in log format string");
+	static_assert(CountFormatPlaceholders(FormatT::value()) == sizeof...(Args), "Log format placeholder count does not match argument count");
+
+	LightLogWriteInfo sLogMessageInf;
+	char* pArgsBytes = sLogMessageInf.AssignDeferred(tagId, FormatT::value(), LogArgsSize(args...));
+	EncodeLogArgs(pArgsBytes, args...);
+	EnqueueLogRecord(std::move(sLogMessageInf));
+}
 
 #endif // !INCLUDE_LIGHTLOGWRITEIMPL_HPP_
 
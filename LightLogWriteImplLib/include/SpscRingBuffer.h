@@ -0,0 +1,125 @@
+#ifndef INCLUDE_SPSCRINGBUFFER_H_
+#define INCLUDE_SPSCRINGBUFFER_H_
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     SpscRingBuffer.h
+ *  @brief    单生产者/单消费者环形缓冲区
+ *  @details  用于每个写日志线程的本地暂存队列
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+	* @brief A bounded single-producer/single-consumer ring buffer
+	* @param T The type of elements stored in the ring, must be default constructible and movable
+	* @details Exactly one thread may call push() and exactly one other thread may call pop().
+	* * The producer owns _tail and the consumer owns _head; each side keeps a cached copy of
+	* * the other side's index so the shared cache line is only read when the cached value says
+	* * the ring looks full (producer) or empty (consumer).
+	* * The capacity is rounded up to a power of two to optimize index calculations.
+	*/
+template <typename T>
+class SpscRingBuffer {
+public:
+	explicit SpscRingBuffer(size_t capacity)
+	{
+		_capacityMask = capacity ? capacity - 1 : 0;
+		for (size_t i = 1; i <= sizeof(void*) * 4; i <<= 1)
+			_capacityMask |= _capacityMask >> i;
+		_capacity = _capacityMask + 1;
+		_queue.reset(new T[_capacity]);
+	}
+
+	SpscRingBuffer(const SpscRingBuffer&) = delete;
+	SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+	size_t capacity() const { return _capacity; }
+
+	size_t size() const
+	{
+		size_t head = _head.load(std::memory_order_acquire);
+		return _tail.load(std::memory_order_acquire) - head;
+	}
+
+	bool empty() const { return size() == 0; }
+
+	/**
+		* @brief Pushes an element, producer thread only
+		* @return false if the ring is full
+		*/
+	bool push(T&& data)
+	{
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		if (tail - _headCache >= _capacity)
+		{
+			_headCache = _head.load(std::memory_order_acquire);
+			if (tail - _headCache >= _capacity)
+				return false;
+		}
+		_queue[tail & _capacityMask] = std::move(data);
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool push(const T& data)
+	{
+		T sCopy(data);
+		return push(std::move(sCopy));
+	}
+
+	/**
+		* @brief Pops the oldest element, consumer thread only
+		* @return false if the ring is empty
+		*/
+	bool pop(T& result)
+	{
+		size_t head = _head.load(std::memory_order_relaxed);
+		if (head == _tailCache)
+		{
+			_tailCache = _tail.load(std::memory_order_acquire);
+			if (head == _tailCache)
+				return false;
+		}
+		result = std::move(_queue[head & _capacityMask]);
+		_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	size_t                               _capacityMask;
+	size_t                               _capacity;
+	std::unique_ptr<T[]>                 _queue;
+	alignas(64) std::atomic<size_t>      _tail{ 0 };      /*!< Producer index            */
+	size_t                               _headCache{ 0 }; /*!< Producer's view of _head  */
+	alignas(64) std::atomic<size_t>      _head{ 0 };      /*!< Consumer index            */
+	size_t                               _tailCache{ 0 }; /*!< Consumer's view of _tail  */
+	char                                 cacheLinePad[64 - sizeof(size_t) * 2];
+};
+
+#endif // !INCLUDE_SPSCRINGBUFFER_H_
@@ -0,0 +1,279 @@
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogDecoder.cpp
+ *  @brief    二进制日志解码工具
+ *  @details  将 LogOutputFormat::Binary 写出的 .llb 文件还原为文本日志格式
+ *            "tag-//>>>YYYY-MM-DD HH:MM:SS : message"
+ *            只依赖 include/LightLogBinaryFormat.h、LightLogFormat.h 与 LightLogUtf8.h 中的内联部分，
+ *            例如: g++ -std=c++17 -I../include LightLogDecoder.cpp -o LightLogDecoder
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <charconv>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include "LightLogBinaryFormat.h"
+#include "LightLogFormat.h"
+
+using namespace LightLogBinary;
+
+namespace {
+
+	struct DecodeState {
+		std::unordered_map<uint64_t, std::string> mTags;     /*!< Tag id to UTF-8 name       */
+		std::unordered_map<uint64_t, std::string> mFormats;  /*!< Format id to UTF-8 format  */
+		uint64_t                                  timeUs = 0;
+		uint64_t                                  sequence = 0;  /*!< Of the next record, 0 if none */
+	};
+
+	bool GetString(const char*& pIn, const char* pEnd, std::string& sOut)
+	{
+		uint64_t len;
+		if (!GetVarint(pIn, pEnd, len) || static_cast<uint64_t>(pEnd - pIn) < len)
+			return false;
+		sOut.assign(pIn, static_cast<size_t>(len));
+		pIn += len;
+		return true;
+	}
+
+	template <typename T>
+	void AppendNumber(std::string& sOut, T value, int base = 10)
+	{
+		char sDigits[32];
+		std::to_chars_result result;
+		if constexpr (std::is_integral_v<T>)
+			result = std::to_chars(sDigits, sDigits + sizeof(sDigits), value, base);
+		else
+			result = std::to_chars(sDigits, sDigits + sizeof(sDigits), value);
+		sOut.append(sDigits, result.ptr);
+	}
+
+	bool AppendArg(std::string& sOut, const char*& pIn, const char* pEnd)
+	{
+		if (pIn >= pEnd)
+			return false;
+		LogArgType type = static_cast<LogArgType>(*pIn++);
+		uint64_t uValue;
+		int64_t iValue;
+		std::string sText;
+		switch (type) {
+		case LogArgType::Int64:
+			if (!GetSVarint(pIn, pEnd, iValue)) return false;
+			AppendNumber(sOut, iValue);
+			return true;
+		case LogArgType::UInt64:
+			if (!GetVarint(pIn, pEnd, uValue)) return false;
+			AppendNumber(sOut, uValue);
+			return true;
+		case LogArgType::Pointer:
+			if (!GetVarint(pIn, pEnd, uValue)) return false;
+			sOut += "0x";
+			AppendNumber(sOut, uValue, 16);
+			return true;
+		case LogArgType::Double: {
+			double dValue;
+			if (pEnd - pIn < static_cast<ptrdiff_t>(sizeof(dValue))) return false;
+			std::memcpy(&dValue, pIn, sizeof(dValue));
+			pIn += sizeof(dValue);
+			AppendNumber(sOut, dValue);
+			return true;
+		}
+		case LogArgType::Bool:
+			if (pIn >= pEnd) return false;
+			sOut += (*pIn++ ? "true" : "false");
+			return true;
+		case LogArgType::Char:
+			if (pIn >= pEnd) return false;
+			sOut += *pIn++;
+			return true;
+		case LogArgType::WChar: {
+			if (!GetVarint(pIn, pEnd, uValue)) return false;
+			wchar_t ch = static_cast<wchar_t>(uValue);
+			AppendUtf8(sOut, std::wstring_view(&ch, 1));
+			return true;
+		}
+		case LogArgType::String:
+		case LogArgType::WString:
+			if (!GetString(pIn, pEnd, sText)) return false;
+			sOut += sText;
+			return true;
+		}
+		return false;
+	}
+
+	void RenderTime(std::string& sOut, uint64_t timeUs)
+	{
+		std::time_t sTimer = static_cast<std::time_t>(timeUs / 1000000);
+		std::tm sTmParts;
+#ifdef _WIN32
+		localtime_s(&sTmParts, &sTimer);
+#else
+		localtime_r(&sTimer, &sTmParts);
+#endif
+		char sBuffer[32];
+		size_t len = std::strftime(sBuffer, sizeof(sBuffer), "%Y-%m-%d %H:%M:%S", &sTmParts);
+		sOut.append(sBuffer, len);
+		// Same ".uuuuuu" suffix as the text lines, see LightLogTimestampCache
+		unsigned micros = static_cast<unsigned>(timeUs % 1000000);
+		char sMicros[8] = { '.' };
+		for (int i = 6; i >= 1; --i, micros /= 10)
+			sMicros[i] = static_cast<char>('0' + micros % 10);
+		sOut.append(sMicros, 7);
+	}
+
+	bool DecodeRecord(const char*& pIn, const char* pEnd, DecodeState& state, std::string& sLine)
+	{
+		int64_t dtUs;
+		uint64_t tagId, formatId, argsLen;
+		if (!GetSVarint(pIn, pEnd, dtUs) || !GetVarint(pIn, pEnd, tagId) || !GetVarint(pIn, pEnd, formatId) ||
+			!GetVarint(pIn, pEnd, argsLen) || static_cast<uint64_t>(pEnd - pIn) < argsLen)
+			return false;
+		state.timeUs += dtUs;
+
+		const char* pArgs = pIn;
+		const char* pArgsEnd = pIn + argsLen;
+		pIn = pArgsEnd;
+
+		sLine.clear();
+		if (state.sequence != 0) {
+			// Same prefix as the text lines, so LightLogMerge takes decoded shards too
+			sLine += '#';
+			AppendNumber(sLine, state.sequence);
+			sLine += ' ';
+			state.sequence = 0;
+		}
+		sLine += state.mTags[tagId];
+		sLine += "-//>>>";
+		RenderTime(sLine, state.timeUs);
+		sLine += " : ";
+
+		const std::string& sFormat = formatId == kPlainMessageFormatId ? std::string("{}") : state.mFormats[formatId];
+		for (size_t i = 0; i < sFormat.size(); ++i) {
+			char ch = sFormat[i];
+			char next = i + 1 < sFormat.size() ? sFormat[i + 1] : '\0';
+			if ((ch == '{' && next == '{') || (ch == '}' && next == '}')) {
+				sLine += ch;
+				++i;
+			}
+			else if (ch == '{' && next == '}') {
+				if (pArgs < pArgsEnd && !AppendArg(sLine, pArgs, pArgsEnd))
+					return false;
+				++i;
+			}
+			else {
+				sLine += ch;
+			}
+		}
+		sLine += '\n';
+		return true;
+	}
+
+	/**
+		* @brief Decodes a whole .llb file into text lines
+		* @return false if the file is truncated or corrupt, the lines decoded so far are kept
+		*/
+	bool DecodeFile(const std::string& sInput, std::ostream& sOutput)
+	{
+		const char* pIn = sInput.data();
+		const char* pEnd = pIn + sInput.size();
+		DecodeState state;
+		std::string sLine;
+
+		while (pIn < pEnd) {
+			if (static_cast<size_t>(pEnd - pIn) >= sizeof(kSegmentMagic) && std::memcmp(pIn, kSegmentMagic, sizeof(kSegmentMagic)) == 0) {
+				pIn += sizeof(kSegmentMagic);
+				if (pEnd - pIn < 9 || static_cast<uint8_t>(*pIn) != kFormatVersion)
+					return false;
+				++pIn;
+				state = DecodeState();
+				for (int i = 0; i < 8; ++i)
+					state.timeUs |= static_cast<uint64_t>(static_cast<uint8_t>(*pIn++)) << (8 * i);
+				continue;
+			}
+
+			uint8_t entry = static_cast<uint8_t>(*pIn++);
+			uint64_t id;
+			std::string sText;
+			switch (entry) {
+			case kEntryTagDef:
+				if (!GetVarint(pIn, pEnd, id) || !GetString(pIn, pEnd, sText))
+					return false;
+				state.mTags[id] = sText;
+				break;
+			case kEntryFormatDef:
+				if (!GetVarint(pIn, pEnd, id) || !GetString(pIn, pEnd, sText))
+					return false;
+				state.mFormats[id] = sText;
+				break;
+			case kEntrySequence:
+				if (!GetVarint(pIn, pEnd, state.sequence))
+					return false;
+				break;
+			case kEntryRecord:
+				if (!DecodeRecord(pIn, pEnd, state, sLine))
+					return false;
+				sOutput << sLine;
+				break;
+			default:
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		std::cerr << "Usage: LightLogDecoder <input.llb> [output.log]\n";
+		return 2;
+	}
+
+	std::ifstream sInputFile(argv[1], std::ios::binary);
+	if (!sInputFile) {
+		std::cerr << "Cannot open " << argv[1] << "\n";
+		return 1;
+	}
+	std::string sInput((std::istreambuf_iterator<char>(sInputFile)), std::istreambuf_iterator<char>());
+
+	std::ofstream sOutputFile;
+	if (argc > 2) {
+		sOutputFile.open(argv[2], std::ios::binary | std::ios::trunc);
+		if (!sOutputFile) {
+			std::cerr << "Cannot open " << argv[2] << "\n";
+			return 1;
+		}
+	}
+
+	if (!DecodeFile(sInput, argc > 2 ? static_cast<std::ostream&>(sOutputFile) : std::cout)) {
+		std::cerr << "Truncated or corrupt input, stopped early\n";
+		return 1;
+	}
+	return 0;
+}
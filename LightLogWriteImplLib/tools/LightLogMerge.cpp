@@ -0,0 +1,194 @@
+/*****************************************************************************
+ *  LightLogWriteImpl
+ *  Copyright (C) 2025 hesphoros <hesphoros@gmail.com>
+ *
+ *  This file is part of LightLogWriteImpl.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  @file     LightLogMerge.cpp
+ *  @brief    分片日志合并工具
+ *  @details  把 LightLogShardedWrite 写出的各分片文本日志按行首的全局序号 "#<序号> " 做 k 路归并，
+ *            还原为一个有序的日志文件；二进制分片先用 LightLogDecoder 解码。
+ *            每个分片内的乱序（多个线程共用一个分片时可能出现）由一个有限的重排窗口消除。
+ *            不依赖库的其他部分，例如: g++ -std=c++17 LightLogMerge.cpp -o LightLogMerge
+ *
+ *  @author   hesphoros
+ *  @email    hesphoros@gmail.com
+ *  @version  1.0.0.1
+ *  @date     2025/06/21
+ *  @license  GNU General Public License (GPL)
+ *---------------------------------------------------------------------------*
+ *  Remark         : None
+ *---------------------------------------------------------------------------*
+ *  Change History :
+ *  <Date>     | <Version> | <Author>       | <Description>
+ *  2025/06/21 | 1.0.0.1   | hesphoros      | Create file
+ *****************************************************************************/
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+	constexpr size_t kDefaultWindow = 1u << 16;  /*!< Records buffered per shard */
+
+	/**
+		* @brief One record: its sequence line and any continuation lines of a multi-line message
+		*/
+	struct MergeRecord {
+		uint64_t     sequence = 0;  /*!< 0 for lines written without a sequence counter */
+		size_t       shard = 0;     /*!< Input the record came from                     */
+		std::string  sText;         /*!< The lines, each with its '\n'                  */
+	};
+
+	struct LaterRecord {
+		bool operator()(const MergeRecord& a, const MergeRecord& b) const
+		{
+			return a.sequence != b.sequence ? a.sequence > b.sequence : a.shard > b.shard;
+		}
+	};
+
+	/**
+		* @brief Parses the "#<sequence> " prefix of a line
+		* @return Size of the prefix, 0 if the line has none
+		*/
+	size_t ParseSequence(std::string_view sLine, uint64_t& sequence)
+	{
+		if (sLine.size() < 3 || sLine[0] != '#')
+			return 0;
+		auto result = std::from_chars(sLine.data() + 1, sLine.data() + sLine.size(), sequence);
+		if (result.ec != std::errc() || result.ptr == sLine.data() + 1 || result.ptr == sLine.data() + sLine.size() || *result.ptr != ' ')
+			return 0;
+		return static_cast<size_t>(result.ptr - sLine.data()) + 1;
+	}
+
+	class ShardReader {
+	public:
+		ShardReader(const char* pszPath, size_t shard, bool bKeepSequence)
+			: sInput(pszPath, std::ios::binary), shard(shard), bKeepSequence(bKeepSequence)
+		{
+		}
+
+		bool IsOpen() const { return static_cast<bool>(sInput); }
+
+		/**
+			* @brief Reads the next record, continuation lines (no sequence prefix) are joined to the record before them
+			*/
+		bool ReadRecord(MergeRecord& sRecord)
+		{
+			if (!bHasPending && !ReadLine())
+				return false;
+			bHasPending = false;
+			sRecord.shard = shard;
+			sRecord.sequence = 0;
+			size_t prefixSize = ParseSequence(sPendingLine, sRecord.sequence);
+			sRecord.sText.assign(sPendingLine, bKeepSequence ? 0 : prefixSize, std::string::npos);
+			uint64_t nextSequence;
+			while (ReadLine()) {
+				if (ParseSequence(sPendingLine, nextSequence) != 0) {
+					bHasPending = true;
+					break;
+				}
+				sRecord.sText += sPendingLine;
+			}
+			return true;
+		}
+
+	private:
+		bool ReadLine()
+		{
+			if (!std::getline(sInput, sPendingLine))
+				return false;
+			sPendingLine += '\n';
+			return true;
+		}
+
+		std::ifstream  sInput;              /*!< The shard file                        */
+		const size_t   shard;               /*!< Index of the input                    */
+		const bool     bKeepSequence;       /*!< Leave "#<sequence> " on the lines     */
+		std::string    sPendingLine;        /*!< Line read ahead, with its '\n'        */
+		bool           bHasPending = false; /*!< sPendingLine starts the next record   */
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	size_t window = kDefaultWindow;
+	bool bKeepSequence = false;
+	std::vector<const char*> vPaths;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--window") == 0 && i + 1 < argc)
+			window = std::stoul(argv[++i]);
+		else if (std::strcmp(argv[i], "--keep-sequence") == 0)
+			bKeepSequence = true;
+		else
+			vPaths.push_back(argv[i]);
+	}
+	if (vPaths.size() < 2 || window == 0) {
+		std::cerr << "Usage: LightLogMerge [--window records] [--keep-sequence] <output.log> <shard0.log> [shard1.log ...]\n";
+		return 2;
+	}
+
+	std::ofstream sOutputFile(vPaths[0], std::ios::binary | std::ios::trunc);
+	if (!sOutputFile) {
+		std::cerr << "Cannot open " << vPaths[0] << "\n";
+		return 1;
+	}
+	std::vector<std::unique_ptr<ShardReader>> vReaders;
+	for (size_t i = 1; i < vPaths.size(); ++i) {
+		vReaders.emplace_back(new ShardReader(vPaths[i], i - 1, bKeepSequence));
+		if (!vReaders.back()->IsOpen()) {
+			std::cerr << "Cannot open " << vPaths[i] << "\n";
+			return 1;
+		}
+	}
+
+	// Every shard keeps up to window records in the heap: a record written up to that many places
+	// late in its shard (threads sharing a shard) still comes out in order
+	// A plain heap rather than std::priority_queue, so the smallest record can be moved out after pop_heap
+	std::vector<MergeRecord> vRecords;
+	MergeRecord sRecord;
+	for (auto& pReader : vReaders)
+		for (size_t i = 0; i < window && pReader->ReadRecord(sRecord); ++i)
+			vRecords.push_back(std::move(sRecord));
+	std::make_heap(vRecords.begin(), vRecords.end(), LaterRecord());
+
+	uint64_t lastSequence = 0;
+	uint64_t outOfOrder = 0;
+	uint64_t written = 0;
+	while (!vRecords.empty()) {
+		std::pop_heap(vRecords.begin(), vRecords.end(), LaterRecord());
+		MergeRecord sNext = std::move(vRecords.back());
+		vRecords.pop_back();
+		if (sNext.sequence < lastSequence)
+			++outOfOrder;
+		lastSequence = (std::max)(lastSequence, sNext.sequence);
+		sOutputFile << sNext.sText;
+		++written;
+		if (vReaders[sNext.shard]->ReadRecord(sRecord)) {
+			vRecords.push_back(std::move(sRecord));
+			std::push_heap(vRecords.begin(), vRecords.end(), LaterRecord());
+		}
+	}
+
+	std::cerr << written << " records merged from " << vReaders.size() << " shards\n";
+	if (outOfOrder != 0) {
+		std::cerr << outOfOrder << " records were further out of order than --window " << window << ", rerun with a larger window\n";
+		return 1;
+	}
+	return 0;
+}
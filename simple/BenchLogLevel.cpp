@@ -0,0 +1,55 @@
+// 编译期裁剪 Trace，运行期阈值设为 Info，用来测量被过滤语句的开销
+#define LIGHTLOG_MIN_LEVEL 1
+#include "LightLogWriteImpl.h"
+
+/*
+ * 该示例测量被日志级别过滤掉的语句的开销：
+ *   1. 低于 LIGHTLOG_MIN_LEVEL 的语句（编译期移除）
+ *   2. 低于 SetLogLevel 阈值的语句（运行期一次 relaxed 原子读取）
+ *   3. 作为对照，通过过滤并真正入队的语句
+ * 参数里的 std::to_string 只有在语句通过过滤时才会被求值。
+ */
+
+static const long long DISABLED_ITERATIONS = 200000000; // 被过滤语句的执行次数
+static const long long ENABLED_ITERATIONS = 1000000;    // 通过过滤语句的执行次数
+
+template <typename Func>
+double MeasureNsPerOp(long long iterations, Func&& func)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	for (long long i = 0; i < iterations; ++i)
+		func(i);
+	auto endTime = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(endTime - startTime).count() / static_cast<double>(iterations);
+}
+
+int main()
+{
+	LightLogWrite_Impl logger;
+	logger.SetLogsFileName(L"BenchLogLevel_result.log");
+	logger.SetLogLevel(LogLevel::Info);
+	LogTagId benchTag = logger.RegisterTag("BENCH");
+
+	double compiledOutNs = MeasureNsPerOp(DISABLED_ITERATIONS, [&](long long i) {
+		LIGHTLOG_WRITE(logger, LogLevel::Trace, benchTag, "trace " + std::to_string(i));
+		});
+
+	double runtimeFilteredNs = MeasureNsPerOp(DISABLED_ITERATIONS, [&](long long i) {
+		LIGHTLOG_WRITE(logger, LogLevel::Debug, benchTag, "debug " + std::to_string(i));
+		});
+
+	double runtimeFilteredLogNs = MeasureNsPerOp(DISABLED_ITERATIONS, [&](long long i) {
+		LIGHTLOG_LOG(logger, LogLevel::Debug, benchTag, LIGHTLOG_FMT("debug {}"), i);
+		});
+
+	double enabledNs = MeasureNsPerOp(ENABLED_ITERATIONS, [&](long long i) {
+		LIGHTLOG_LOG(logger, LogLevel::Info, benchTag, LIGHTLOG_FMT("info {}"), i);
+		});
+
+	std::cout << "------ Disabled log statement cost ------\n"
+		<< "Compiled out (Trace < LIGHTLOG_MIN_LEVEL) : " << compiledOutNs << " ns/op\n"
+		<< "Runtime filtered LIGHTLOG_WRITE (Debug)   : " << runtimeFilteredNs << " ns/op\n"
+		<< "Runtime filtered LIGHTLOG_LOG (Debug)     : " << runtimeFilteredLogNs << " ns/op\n"
+		<< "Enabled LIGHTLOG_LOG (Info), for contrast : " << enabledNs << " ns/op\n";
+	return 0;
+}
@@ -0,0 +1,109 @@
+#include "LockFreeLogWriteImpl.hpp"
+
+/*
+ * 该示例测量 LockFreeQueue 槽位布局对多生产者竞争的影响：
+ *   Packed  : 槽位按 alignof(size_t) 紧密排列，相邻槽位共享缓存行，
+ *             生产者填写槽位 i 时与消费者释放槽位 i-1 发生伪共享
+ *   Aligned : 槽位按缓存行对齐（默认），序号与数据头部在同一缓存行
+ * 分别用 48 字节的小记录和 LightLogWrite_Info 测试 2/4/8/16 个生产者线程，
+ * 一个消费者线程持续取出，输出总吞吐量与生产者每次入队的平均耗时。
+ */
+
+static const size_t QUEUE_CAPACITY = 1 << 16;     // 队列容量
+static const size_t RECORDS_PER_PRODUCER = 500000; // 每个生产者入队的记录数
+static const int PRODUCER_COUNTS[] = { 2, 4, 8, 16 };
+
+struct SmallRecord {
+	uint64_t  values[6];
+};
+
+template <typename T>
+T MakeRecord(size_t i)
+{
+	T sRecord{};
+	std::memcpy(&sRecord, &i, sizeof(i));
+	return sRecord;
+}
+
+template <>
+LightLogWrite_Info MakeRecord<LightLogWrite_Info>(size_t i)
+{
+	return LightLogWrite_Info("BENCH", "queue contention record " + std::to_string(i));
+}
+
+struct BenchResult {
+	double  throughputMops = 0; // 百万条/秒
+	double  producerNsPerOp = 0;
+};
+
+template <typename T, size_t SlotAlign>
+BenchResult RunBench(int producerCount)
+{
+	LockFreeQueue<T, SlotAlign> sQueue(QUEUE_CAPACITY);
+	std::atomic<int> readyCount{ 0 };
+	std::atomic<bool> bStart{ false };
+	std::atomic<uint64_t> producerNs{ 0 };
+	const size_t totalRecords = RECORDS_PER_PRODUCER * producerCount;
+
+	std::thread sConsumer([&] {
+		T sRecord;
+		for (size_t popped = 0; popped < totalRecords;) {
+			if (sQueue.pop(sRecord))
+				++popped;
+			else
+				LightLogCpuRelax();
+		}
+		});
+
+	std::vector<std::thread> vProducers;
+	for (int t = 0; t < producerCount; ++t) {
+		vProducers.emplace_back([&] {
+			T sRecord = MakeRecord<T>(static_cast<size_t>(t));
+			++readyCount;
+			while (!bStart.load(std::memory_order_acquire)) {
+			}
+			auto startTime = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < RECORDS_PER_PRODUCER; ++i) {
+				while (!sQueue.push(sRecord))
+					std::this_thread::yield();
+			}
+			auto elapsed = std::chrono::steady_clock::now() - startTime;
+			producerNs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+			});
+	}
+	while (readyCount.load() != producerCount)
+		std::this_thread::yield();
+
+	auto startTime = std::chrono::steady_clock::now();
+	bStart.store(true, std::memory_order_release);
+	for (auto& sProducer : vProducers)
+		sProducer.join();
+	sConsumer.join();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	BenchResult sResult;
+	sResult.throughputMops = static_cast<double>(totalRecords) / seconds / 1e6;
+	sResult.producerNsPerOp = static_cast<double>(producerNs.load()) / static_cast<double>(totalRecords);
+	return sResult;
+}
+
+template <typename T>
+void RunLayouts(const char* pName)
+{
+	std::cout << "------ " << pName << " (" << sizeof(T) << " bytes) ------\n";
+	for (int producerCount : PRODUCER_COUNTS) {
+		BenchResult sPacked = RunBench<T, alignof(size_t)>(producerCount);
+		BenchResult sAligned = RunBench<T, kLockFreeCacheLineSize>(producerCount);
+		std::cout << std::setw(2) << producerCount << " producers | Packed "
+			<< std::fixed << std::setprecision(2) << sPacked.throughputMops << " Mops/s, "
+			<< sPacked.producerNsPerOp << " ns/op | Aligned "
+			<< sAligned.throughputMops << " Mops/s, " << sAligned.producerNsPerOp << " ns/op\n";
+	}
+}
+
+int main()
+{
+	RunLayouts<SmallRecord>("SmallRecord");
+	RunLayouts<LightLogWrite_Info>("LightLogWrite_Info");
+	return 0;
+}